@@ -193,7 +193,8 @@ void StackWithBonuses::spendMana(const spells::PacketSender * server, const int
 
 HypotheticBattle::HypotheticBattle(Subject realBattle)
 	: BattleProxy(realBattle),
-	bonusTreeVersion(1)
+	bonusTreeVersion(CBonusSystemNode::allocateChangeStamp()),
+	battleNodeVersion(-1)
 {
 	auto activeUnit = realBattle->battleActiveUnit();
 	activeUnitId = activeUnit ? activeUnit->unitId() : -1;
@@ -346,19 +347,19 @@ void HypotheticBattle::removeUnit(uint32_t id)
 void HypotheticBattle::addUnitBonus(uint32_t id, const std::vector<Bonus> & bonus)
 {
 	getForUpdate(id)->addUnitBonus(bonus);
-	bonusTreeVersion++;
+	bonusTreeVersion = CBonusSystemNode::allocateChangeStamp();
 }
 
 void HypotheticBattle::updateUnitBonus(uint32_t id, const std::vector<Bonus> & bonus)
 {
 	getForUpdate(id)->updateUnitBonus(bonus);
-	bonusTreeVersion++;
+	bonusTreeVersion = CBonusSystemNode::allocateChangeStamp();
 }
 
 void HypotheticBattle::removeUnitBonus(uint32_t id, const std::vector<Bonus> & bonus)
 {
 	getForUpdate(id)->removeUnitBonus(bonus);
-	bonusTreeVersion++;
+	bonusTreeVersion = CBonusSystemNode::allocateChangeStamp();
 }
 
 void HypotheticBattle::setWallState(int partOfWall, si8 state)
@@ -388,5 +389,14 @@ int64_t HypotheticBattle::getActualDamage(const TDmgRange & damage, int32_t atta
 
 int64_t HypotheticBattle::getTreeVersion() const
 {
-	return getBattleNode()->getTreeVersion() + bonusTreeVersion;
+	int64_t realVersion = getBattleNode()->getTreeVersion();
+
+	if(realVersion != battleNodeVersion)
+	{
+		battleNodeVersion = realVersion;
+		bonusTreeVersion = CBonusSystemNode::allocateChangeStamp();
+	}
+
+	//global epoch of real battle node is kept so global invalidation still applies
+	return ((realVersion >> 32) << 32) + static_cast<uint32_t>(bonusTreeVersion);
 }
@@ -107,7 +107,10 @@ public:
 	int64_t getTreeVersion() const;
 
 private:
-	int32_t bonusTreeVersion;
+	/// Stamp allocated by bonus system on every hypothetic bonus change or change of real battle node,
+	/// so version never matches one cached for different state
+	mutable int32_t bonusTreeVersion;
+	mutable int64_t battleNodeVersion; //version of real battle node when bonusTreeVersion was allocated
 	int32_t activeUnitId;
 	mutable uint32_t nextId;
 };
@@ -138,6 +138,16 @@ std::vector<AIPath> AIhelper::getPathsToTile(HeroPtr hero, int3 tile)
 	return pathfindingManager->getPathsToTile(hero, tile);
 }
 
+void AIhelper::updatePaths(std::vector<HeroPtr> heroes)
+{
+	pathfindingManager->updatePaths(heroes);
+}
+
+void AIhelper::invalidateTiles(const std::vector<int3> & tiles)
+{
+	pathfindingManager->invalidateTiles(tiles);
+}
+
 void AIhelper::resetPaths()
 {
 	pathfindingManager->resetPaths();
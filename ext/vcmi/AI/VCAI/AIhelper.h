@@ -58,6 +58,8 @@ public:
 	Goals::TGoalVec howToVisitTile(int3 tile) override;
 	Goals::TGoalVec howToVisitObj(ObjectIdRef obj) override;
 	std::vector<AIPath> getPathsToTile(HeroPtr hero, int3 tile) override;
+	void updatePaths(std::vector<HeroPtr> heroes) override;
+	void invalidateTiles(const std::vector<int3> & tiles) override;
 	void resetPaths() override;
 
 private:
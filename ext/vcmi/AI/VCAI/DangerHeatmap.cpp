@@ -0,0 +1,261 @@
+/*
+* DangerHeatmap.cpp, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#include "StdInc.h"
+#include "DangerHeatmap.h"
+#include "VCAI.h"
+#include "FuzzyHelper.h"
+
+#include "../../CCallback.h"
+#include "../../lib/mapping/CMapDefines.h"
+
+extern boost::thread_specific_ptr<CCallback> cb;
+extern boost::thread_specific_ptr<VCAI> ai;
+extern FuzzyHelper * fh;
+
+const ui64 DangerHeatmap::UNKNOWN_TILE_DANGER;
+
+namespace
+{
+	ui64 evaluateTileDanger(crint3 tile)
+	{
+		const TerrainTile * t = cb->getTile(tile, false);
+		if(!t)
+			return DangerHeatmap::UNKNOWN_TILE_DANGER;
+
+		ui64 objectDanger = 0;
+		ui64 guardDanger = 0;
+
+		auto visObjs = cb->getVisitableObjs(tile);
+		if(visObjs.size())
+			objectDanger = evaluateDanger(visObjs.back());
+
+		int3 guardPos = cb->getGuardingCreaturePosition(tile);
+		if(guardPos.x >= 0 && guardPos != tile)
+			guardDanger = evaluateTileDanger(guardPos);
+
+		//TODO mozna odwiedzic blockvis nie ruszajac straznika
+		return std::max(objectDanger, guardDanger);
+	}
+}
+
+DangerHeatmap::TileDanger::TileDanger():
+	generation(0),
+	firstThreat(0),
+	threatCount(0),
+	danger(0),
+	visible(false)
+{
+}
+
+DangerHeatmap::DangerHeatmap():
+	mapSize(0, 0, 0),
+	generation(1),
+	dirty(true)
+{
+}
+
+ui64 DangerHeatmap::getDanger(const int3 & tile)
+{
+	std::vector<Threat> tileThreats;
+
+	return getTileDanger(tile, tileThreats).danger;
+}
+
+ui64 DangerHeatmap::getDanger(const int3 & tile, const CGHeroInstance * visitor)
+{
+	std::vector<Threat> tileThreats;
+	TileDanger td = getTileDanger(tile, tileThreats);
+
+	if(!td.visible)
+		return UNKNOWN_TILE_DANGER;
+
+	ui64 danger = 0;
+	for(const Threat & threat : tileThreats)
+	{
+		if(threat.army)
+			vstd::amax(danger, static_cast<ui64>(threat.strength * fh->tacticalAdvantageEngine.getTacticalAdvantage(visitor, threat.army)));
+		else
+			vstd::amax(danger, threat.strength);
+	}
+	return danger;
+}
+
+DangerHeatmap::TileDanger DangerHeatmap::getTileDanger(const int3 & tile, std::vector<Threat> & tileThreats)
+{
+	auto copyTile = [&]() -> TileDanger
+	{
+		TileDanger & td = tileDanger(tile);
+		tileThreats.assign(threats.begin() + td.firstThreat, threats.begin() + td.firstThreat + td.threatCount);
+		return td;
+	};
+
+	if(!dirty)
+	{
+		boost::shared_lock<boost::shared_mutex> lock(mx);
+		if(!dirty && isValid(tile) && tileDanger(tile).generation == generation)
+			return copyTile();
+	}
+
+	boost::unique_lock<boost::shared_mutex> lock(mx);
+	update();
+
+	if(!isValid(tile))
+	{
+		TileDanger unknown;
+		unknown.danger = UNKNOWN_TILE_DANGER;
+		return unknown;
+	}
+
+	if(tileDanger(tile).generation != generation)
+		updateTile(tile);
+
+	return copyTile();
+}
+
+void DangerHeatmap::invalidateAll()
+{
+	boost::unique_lock<boost::shared_mutex> lock(mx);
+	generation++;
+	threats.clear();
+	pendingTiles.clear();
+
+	/// Zero is never valid generation, on overflow all tiles are invalidated explicitly
+	if(!generation)
+	{
+		for(TileDanger & td : tiles)
+			td.generation = 0;
+		generation = 1;
+	}
+}
+
+void DangerHeatmap::invalidate(const CGObjectInstance * obj)
+{
+	auto blockedTiles = obj->getBlockedPos();
+	std::vector<int3> changed(blockedTiles.begin(), blockedTiles.end());
+	changed.push_back(obj->visitablePos());
+	invalidate(changed);
+}
+
+void DangerHeatmap::invalidate(const std::vector<int3> & tiles)
+{
+	boost::unique_lock<boost::shared_mutex> lock(mx);
+	vstd::concatenate(pendingTiles, tiles);
+	dirty = true;
+}
+
+void DangerHeatmap::update()
+{
+	if(!dirty)
+		return;
+
+	if(tiles.empty())
+	{
+		mapSize = cb->getMapSize();
+		tiles.resize(mapSize.x * mapSize.y * mapSize.z);
+	}
+
+	//monsters guard neighbouring tiles, so their dangers change as well
+	std::set<int3> changed;
+	for(const int3 & pos : pendingTiles)
+	{
+		for(int dx = -1; dx <= 1; dx++)
+		{
+			for(int dy = -1; dy <= 1; dy++)
+			{
+				int3 tile(pos.x + dx, pos.y + dy, pos.z);
+				if(isValid(tile))
+					changed.insert(tile);
+			}
+		}
+	}
+
+	//danger of subterranean gate includes guards on the other side
+	if(!changed.empty())
+	{
+		for(auto & gates : ai->knownSubterraneanGates)
+		{
+			int3 otherSide = gates.second->visitablePos();
+			if(vstd::contains_if(changed, [&](const int3 & tile){ return tile.z == otherSide.z && tile.dist2dSQ(otherSide) <= 2; }))
+				changed.insert(gates.first->visitablePos());
+		}
+	}
+
+	for(const int3 & tile : changed)
+		tileDanger(tile).generation = 0;
+
+	pendingTiles.clear();
+	dirty = false;
+}
+
+void DangerHeatmap::updateTile(const int3 & tile)
+{
+	TileDanger & td = tileDanger(tile);
+	td.generation = generation;
+	td.firstThreat = threats.size();
+	td.threatCount = 0;
+	td.danger = evaluateTileDanger(tile);
+	td.visible = cb->getTile(tile, false) != nullptr;
+
+	if(!td.visible)
+		return;
+
+	auto visitableObjects = cb->getVisitableObjs(tile);
+	// in some scenarios hero happens to be "under" the object (eg town). Then we consider ONLY the hero.
+	if(vstd::contains_if(visitableObjects, objWithID<Obj::HERO>))
+	{
+		vstd::erase_if(visitableObjects, [](const CGObjectInstance * obj)
+		{
+			return !objWithID<Obj::HERO>(obj);
+		});
+	}
+
+	if(const CGObjectInstance * dangerousObject = vstd::backOrNull(visitableObjects))
+	{
+		//unguarded objects can also be dangerous or unhandled
+		//TODO: don't downcast objects AI shouldn't know about!
+		addThreat(td, dynamic_cast<const CArmedInstance *>(dangerousObject), evaluateDanger(dangerousObject));
+
+		if(dangerousObject->ID == Obj::SUBTERRANEAN_GATE)
+		{
+			//check guard on the other side of the gate
+			auto it = ai->knownSubterraneanGates.find(dangerousObject);
+			if(it != ai->knownSubterraneanGates.end())
+			{
+				for(auto cre : cb->getGuardingCreatures(it->second->visitablePos()))
+					addThreat(td, dynamic_cast<const CArmedInstance *>(cre), evaluateDanger(cre));
+			}
+		}
+	}
+
+	for(auto cre : cb->getGuardingCreatures(tile))
+		addThreat(td, dynamic_cast<const CArmedInstance *>(cre), evaluateDanger(cre));
+}
+
+void DangerHeatmap::addThreat(TileDanger & td, const CArmedInstance * army, ui64 strength)
+{
+	if(!strength)
+		return;
+
+	Threat threat;
+	threat.army = army;
+	threat.strength = strength;
+	threats.push_back(threat);
+	td.threatCount++;
+}
+
+DangerHeatmap::TileDanger & DangerHeatmap::tileDanger(const int3 & tile)
+{
+	return tiles[(tile.z * mapSize.y + tile.y) * mapSize.x + tile.x];
+}
+
+bool DangerHeatmap::isValid(const int3 & tile) const
+{
+	return tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < mapSize.x && tile.y < mapSize.y && tile.z < mapSize.z;
+}
@@ -0,0 +1,77 @@
+/*
+* DangerHeatmap.h, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#pragma once
+
+#include "../../lib/int3.h"
+
+class CArmedInstance;
+class CGHeroInstance;
+class CGObjectInstance;
+
+/// Dangers of map tiles, each tile is collected on first query in a turn and again after objects around it change.
+/// Every tile keeps its threats - dangerous object on it and monsters guarding it.
+/// Danger for a hero is strength of the worst threat scaled by tactical advantage of the threat against that hero
+class DangerHeatmap
+{
+public:
+	/// returned for tiles hidden by fog of war, we can know about guard but can't check its tile
+	static const ui64 UNKNOWN_TILE_DANGER = 190000000;
+
+	DangerHeatmap();
+
+	/// danger of tile regardless of visiting hero
+	ui64 getDanger(const int3 & tile);
+	/// danger of tile for given hero
+	ui64 getDanger(const int3 & tile, const CGHeroInstance * visitor);
+
+	/// all tiles are collected again on next query, to be called at start of turn
+	void invalidateAll();
+	/// tiles around changed object are collected again on next query
+	void invalidate(const CGObjectInstance * obj);
+	void invalidate(const std::vector<int3> & tiles);
+
+private:
+	struct Threat
+	{
+		const CArmedInstance * army; //nullptr if danger does not depend on visitor
+		ui64 strength;
+	};
+
+	struct TileDanger
+	{
+		ui32 generation; //tile is up to date if it matches generation of heatmap
+		ui32 firstThreat; //index in threats
+		ui32 threatCount;
+		ui64 danger; //regardless of visitor
+		bool visible;
+
+		TileDanger();
+	};
+
+	int3 mapSize;
+	std::vector<TileDanger> tiles;
+	/// threats of collected tiles, recollected tile gets new range at the end and old one is dropped with next generation
+	std::vector<Threat> threats;
+	ui32 generation;
+
+	std::atomic<bool> dirty; //there are pending invalidations
+	std::vector<int3> pendingTiles;
+	boost::shared_mutex mx;
+
+	/// returns up to date danger of tile together with its threats, can be called from any thread with AI state set
+	TileDanger getTileDanger(const int3 & tile, std::vector<Threat> & tileThreats);
+	/// applies pending invalidations, caller must hold exclusive lock
+	void update();
+	void updateTile(const int3 & tile);
+	void addThreat(TileDanger & td, const CArmedInstance * army, ui64 strength);
+
+	TileDanger & tileDanger(const int3 & tile);
+	bool isValid(const int3 & tile) const;
+};
@@ -9,8 +9,10 @@
 */
 #include "StdInc.h"
 #include "FuzzyEngines.h"
+#include "FuzzyGoalRules.h"
 
 #include "../../lib/mapObjects/MapObjects.h"
+#include "../../lib/CConfigHandler.h"
 #include "VCAI.h"
 #include "MapObjectsEvaluator.h"
 
@@ -26,7 +28,7 @@ engineBase::engineBase()
 
 void engineBase::configure()
 {
-	engine.configure("Minimum", "Maximum", "Minimum", "AlgebraicSum", "Centroid", "Proportional");
+	configureFuzzyEngine(engine);
 	logAi->info(engine.toString());
 }
 
@@ -192,12 +194,24 @@ TacticalAdvantageEngine::TacticalAdvantageEngine()
 
 float TacticalAdvantageEngine::getTacticalAdvantage(const CArmedInstance * we, const CArmedInstance * enemy)
 {
+	armyStructure ourStructure = evaluateArmyStructure(we);
+	armyStructure enemyStructure = evaluateArmyStructure(enemy);
+	bool bank = dynamic_cast<const CBank *>(enemy);
+	const CGTownInstance * fort = dynamic_cast<const CGTownInstance *>(enemy);
+
+	TInputs inputs(ourStructure.walkers, ourStructure.shooters, ourStructure.flyers, ourStructure.maxSpeed,
+		enemyStructure.walkers, enemyStructure.shooters, enemyStructure.flyers, enemyStructure.maxSpeed,
+		bank, fort ? fort->fortLevel() : 0);
+
+	boost::unique_lock<boost::mutex> lock(mx);
+
+	auto cached = advantageCache.find(inputs);
+	if(cached != advantageCache.end())
+		return cached->second;
+
 	float output = 1;
 	try
 	{
-		armyStructure ourStructure = evaluateArmyStructure(we);
-		armyStructure enemyStructure = evaluateArmyStructure(enemy);
-
 		ourWalkers->setValue(ourStructure.walkers);
 		ourShooters->setValue(ourStructure.shooters);
 		ourFlyers->setValue(ourStructure.flyers);
@@ -208,13 +222,11 @@ float TacticalAdvantageEngine::getTacticalAdvantage(const CArmedInstance * we, c
 		enemyFlyers->setValue(enemyStructure.flyers);
 		enemySpeed->setValue(enemyStructure.maxSpeed);
 
-		bool bank = dynamic_cast<const CBank *>(enemy);
 		if(bank)
 			bankPresent->setValue(1);
 		else
 			bankPresent->setValue(0);
 
-		const CGTownInstance * fort = dynamic_cast<const CGTownInstance *>(enemy);
 		if(fort)
 			castleWalls->setValue(fort->fortLevel());
 		else
@@ -240,6 +252,11 @@ float TacticalAdvantageEngine::getTacticalAdvantage(const CArmedInstance * we, c
 		assert(false);
 	}
 
+	//inputs are fractions of army strength, so variety is limited, but keep cache bounded anyway
+	if(advantageCache.size() >= 10000)
+		advantageCache.clear();
+	advantageCache[inputs] = output;
+
 	return output;
 }
 
@@ -249,67 +266,12 @@ HeroMovementGoalEngineBase::HeroMovementGoalEngineBase()
 {
 	try
 	{
-		strengthRatio = new fl::InputVariable("strengthRatio"); //hero must be strong enough to defeat guards
-		heroStrength = new fl::InputVariable("heroStrength"); //we want to use weakest possible hero
-		turnDistance = new fl::InputVariable("turnDistance"); //we want to use hero who is near
-		missionImportance = new fl::InputVariable("lockedMissionImportance"); //we may want to preempt hero with low-priority mission
-		value = new fl::OutputVariable("Value");
-		value->setMinimum(0);
-		value->setMaximum(5);
-
-		std::vector<fl::InputVariable *> helper = { strengthRatio, heroStrength, turnDistance, missionImportance };
-		for(auto val : helper)
-		{
-			engine.addInputVariable(val);
-		}
-		engine.addOutputVariable(value);
-
-		strengthRatio->addTerm(new fl::Ramp("LOW", SAFE_ATTACK_CONSTANT, 0));
-		strengthRatio->addTerm(new fl::Ramp("HIGH", SAFE_ATTACK_CONSTANT, SAFE_ATTACK_CONSTANT * 3));
-		strengthRatio->setRange(0, SAFE_ATTACK_CONSTANT * 3);
-
-		//strength compared to our main hero
-		heroStrength->addTerm(new fl::Ramp("LOW", 0.5, 0));
-		heroStrength->addTerm(new fl::Triangle("MEDIUM", 0.2, 0.8));
-		heroStrength->addTerm(new fl::Ramp("HIGH", 0.5, 1));
-		heroStrength->setRange(0.0, 1.0);
-
-		turnDistance->addTerm(new fl::Ramp("SHORT", 0.5, 0));
-		turnDistance->addTerm(new fl::Triangle("MEDIUM", 0.1, 0.8));
-		turnDistance->addTerm(new fl::Ramp("LONG", 0.5, 3));
-		turnDistance->setRange(0.0, 3.0);
-
-		missionImportance->addTerm(new fl::Ramp("LOW", 2.5, 0));
-		missionImportance->addTerm(new fl::Triangle("MEDIUM", 2, 3));
-		missionImportance->addTerm(new fl::Ramp("HIGH", 2.5, 5));
-		missionImportance->setRange(0.0, 5.0);
-
-		//an issue: in 99% cases this outputs center of mass (2.5) regardless of actual input :/
-		//should be same as "mission Importance" to keep consistency
-		value->addTerm(new fl::Ramp("LOW", 2.5, 0));
-		value->addTerm(new fl::Triangle("MEDIUM", 2, 3)); //can't be center of mass :/
-		value->addTerm(new fl::Ramp("HIGH", 2.5, 5));
-		value->setRange(0.0, 5.0);
-
-		//use unarmed scouts if possible
-		addRule("if strengthRatio is HIGH and heroStrength is LOW then Value is HIGH");
-		//we may want to use secondary hero(es) rather than main hero
-		addRule("if strengthRatio is HIGH and heroStrength is MEDIUM then Value is MEDIUM");
-		addRule("if strengthRatio is HIGH and heroStrength is HIGH then Value is LOW");
-		//don't assign targets to heroes who are too weak, but prefer targets of our main hero (in case we need to gather army)
-		addRule("if strengthRatio is LOW and heroStrength is LOW then Value is LOW");
-		//attempt to arm secondary heroes is not stupid
-		addRule("if strengthRatio is LOW and heroStrength is MEDIUM then Value is HIGH");
-		addRule("if strengthRatio is LOW and heroStrength is HIGH then Value is LOW");
-
-		//do not cancel important goals
-		addRule("if lockedMissionImportance is HIGH then Value is LOW");
-		addRule("if lockedMissionImportance is MEDIUM then Value is MEDIUM");
-		addRule("if lockedMissionImportance is LOW then Value is HIGH");
-		//pick nearby objects if it's easy, avoid long walks
-		addRule("if turnDistance is SHORT then Value is HIGH");
-		addRule("if turnDistance is MEDIUM then Value is MEDIUM");
-		addRule("if turnDistance is LONG then Value is LOW");
+		HeroMovementGoalVariables vars = addHeroMovementGoalRules(engine, rules, SAFE_ATTACK_CONSTANT);
+		strengthRatio = vars.strengthRatio;
+		heroStrength = vars.heroStrength;
+		turnDistance = vars.turnDistance;
+		missionImportance = vars.missionImportance;
+		value = vars.value;
 	}
 	catch(fl::Exception & fe)
 	{
@@ -342,24 +304,27 @@ void HeroMovementGoalEngineBase::setSharedFuzzyVariables(Goals::AbstractGoal & g
 	}
 }
 
-VisitObjEngine::VisitObjEngine()
+float HeroMovementGoalEngineBase::processValue(const std::vector<int> & subdivisions)
 {
-	try
+	if(!settings["server"]["aiFuzzyLookupTables"].Bool())
 	{
-		objectValue = new fl::InputVariable("objectValue"); //value of that object type known by AI
-
-		engine.addInputVariable(objectValue);
+		engine.process();
+		return value->getValue();
+	}
 
-		//objectValue ranges are based on checking RMG priorities of some objects and checking LOW/MID/HIGH proportions for various values in QtFuzzyLite
-		objectValue->addTerm(new fl::Ramp("LOW", 3500.0, 0.0));
-		objectValue->addTerm(new fl::Triangle("MEDIUM", 0.0, 8500.0));
-		std::vector<fl::Discrete::Pair> multiRamp = { fl::Discrete::Pair(5000.0, 0.0), fl::Discrete::Pair(10000.0, 0.75), fl::Discrete::Pair(20000.0, 1.0) };
-		objectValue->addTerm(new fl::Discrete("HIGH", multiRamp));
-		objectValue->setRange(0.0, 20000.0); //relic artifact value is border value by design, even better things are scaled down.
+	if(!valueTable.isBuilt())
+	{
+		valueTable.build(engine, engine.inputVariables(), value, subdivisions);
+		logAi->debug("Fuzzy lookup table for %d inputs has %d points", engine.numberOfInputVariables(), valueTable.size());
+	}
+	return valueTable.evaluate();
+}
 
-		addRule("if objectValue is HIGH then Value is HIGH");
-		addRule("if objectValue is MEDIUM then Value is MEDIUM");
-		addRule("if objectValue is LOW then Value is LOW");
+VisitObjEngine::VisitObjEngine()
+{
+	try
+	{
+		objectValue = addObjectValueRules(engine, rules);
 	}
 	catch(fl::Exception & fe)
 	{
@@ -395,8 +360,7 @@ float VisitObjEngine::evaluate(Goals::VisitObj & goal)
 	try
 	{
 		objectValue->setValue(objValue);
-		engine.process();
-		output = value->getValue();
+		output = processValue(VISIT_OBJ_TABLE_SUBDIVISIONS);
 	}
 	catch(fl::Exception & fe)
 	{
@@ -423,8 +387,7 @@ float VisitTileEngine::evaluate(Goals::VisitTile & goal)
 
 	try
 	{
-		engine.process();
-		goal.priority = value->getValue();
+		goal.priority = processValue(VISIT_TILE_TABLE_SUBDIVISIONS);
 	}
 	catch(fl::Exception & fe)
 	{
@@ -10,6 +10,7 @@
 #pragma once
 #include "fl/Headers.h"
 #include "Goals.h"
+#include "FuzzyLookupTable.h"
 
 class CArmedInstance;
 
@@ -30,6 +31,12 @@ public:
 	TacticalAdvantageEngine();
 	float getTacticalAdvantage(const CArmedInstance * we, const CArmedInstance * enemy); //returns factor how many times enemy is stronger than us
 private:
+	//engine inputs: our walkers, shooters, flyers, speed, the same for enemy, bank present and castle walls
+	typedef std::tuple<float, float, float, ui32, float, float, float, ui32, bool, int> TInputs;
+
+	std::map<TInputs, float> advantageCache; //results of inference, same army structures give same advantage
+	boost::mutex mx; //guards engine and cache, danger is evaluated by pathfinder threads too
+
 	fl::InputVariable * ourWalkers, *ourShooters, *ourFlyers, *enemyWalkers, *enemyShooters, *enemyFlyers;
 	fl::InputVariable * ourSpeed, *enemySpeed;
 	fl::InputVariable * bankPresent;
@@ -44,6 +51,8 @@ public:
 
 protected:
 	void setSharedFuzzyVariables(Goals::AbstractGoal & goal);
+	/// output for current input values, taken from lookup table if enabled
+	float processValue(const std::vector<int> & subdivisions);
 
 	fl::InputVariable * strengthRatio;
 	fl::InputVariable * heroStrength;
@@ -52,6 +61,8 @@ protected:
 	fl::OutputVariable * value;
 
 private:
+	FuzzyLookupTable valueTable;
+
 	float calculateTurnDistanceInputValue(const CGHeroInstance * h, int3 tile) const;
 };
 
@@ -0,0 +1,116 @@
+/*
+* FuzzyGoalRules.cpp, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#include "StdInc.h"
+#include "FuzzyGoalRules.h"
+
+const std::vector<int> VISIT_TILE_TABLE_SUBDIVISIONS = {8, 8, 3, 2};
+const std::vector<int> VISIT_OBJ_TABLE_SUBDIVISIONS = {4, 4, 2, 2, 1};
+
+namespace
+{
+	void addRule(fl::Engine & engine, fl::RuleBlock & rules, const std::string & txt)
+	{
+		rules.addRule(fl::Rule::parse(txt, &engine));
+	}
+}
+
+void configureFuzzyEngine(fl::Engine & engine)
+{
+	engine.configure("Minimum", "Maximum", "Minimum", "AlgebraicSum", "Centroid", "Proportional");
+}
+
+HeroMovementGoalVariables addHeroMovementGoalRules(fl::Engine & engine, fl::RuleBlock & rules, double safeAttackRatio)
+{
+	HeroMovementGoalVariables vars;
+
+	vars.strengthRatio = new fl::InputVariable("strengthRatio");
+	vars.heroStrength = new fl::InputVariable("heroStrength");
+	vars.turnDistance = new fl::InputVariable("turnDistance");
+	vars.missionImportance = new fl::InputVariable("lockedMissionImportance");
+	vars.value = new fl::OutputVariable("Value");
+	vars.value->setMinimum(0);
+	vars.value->setMaximum(5);
+
+	std::vector<fl::InputVariable *> helper = { vars.strengthRatio, vars.heroStrength, vars.turnDistance, vars.missionImportance };
+	for(auto val : helper)
+	{
+		engine.addInputVariable(val);
+	}
+	engine.addOutputVariable(vars.value);
+
+	vars.strengthRatio->addTerm(new fl::Ramp("LOW", safeAttackRatio, 0));
+	vars.strengthRatio->addTerm(new fl::Ramp("HIGH", safeAttackRatio, safeAttackRatio * 3));
+	vars.strengthRatio->setRange(0, safeAttackRatio * 3);
+
+	//strength compared to our main hero
+	vars.heroStrength->addTerm(new fl::Ramp("LOW", 0.5, 0));
+	vars.heroStrength->addTerm(new fl::Triangle("MEDIUM", 0.2, 0.8));
+	vars.heroStrength->addTerm(new fl::Ramp("HIGH", 0.5, 1));
+	vars.heroStrength->setRange(0.0, 1.0);
+
+	vars.turnDistance->addTerm(new fl::Ramp("SHORT", 0.5, 0));
+	vars.turnDistance->addTerm(new fl::Triangle("MEDIUM", 0.1, 0.8));
+	vars.turnDistance->addTerm(new fl::Ramp("LONG", 0.5, 3));
+	vars.turnDistance->setRange(0.0, 3.0);
+
+	vars.missionImportance->addTerm(new fl::Ramp("LOW", 2.5, 0));
+	vars.missionImportance->addTerm(new fl::Triangle("MEDIUM", 2, 3));
+	vars.missionImportance->addTerm(new fl::Ramp("HIGH", 2.5, 5));
+	vars.missionImportance->setRange(0.0, 5.0);
+
+	//an issue: in 99% cases this outputs center of mass (2.5) regardless of actual input :/
+	//should be same as "mission Importance" to keep consistency
+	vars.value->addTerm(new fl::Ramp("LOW", 2.5, 0));
+	vars.value->addTerm(new fl::Triangle("MEDIUM", 2, 3)); //can't be center of mass :/
+	vars.value->addTerm(new fl::Ramp("HIGH", 2.5, 5));
+	vars.value->setRange(0.0, 5.0);
+
+	//use unarmed scouts if possible
+	addRule(engine, rules, "if strengthRatio is HIGH and heroStrength is LOW then Value is HIGH");
+	//we may want to use secondary hero(es) rather than main hero
+	addRule(engine, rules, "if strengthRatio is HIGH and heroStrength is MEDIUM then Value is MEDIUM");
+	addRule(engine, rules, "if strengthRatio is HIGH and heroStrength is HIGH then Value is LOW");
+	//don't assign targets to heroes who are too weak, but prefer targets of our main hero (in case we need to gather army)
+	addRule(engine, rules, "if strengthRatio is LOW and heroStrength is LOW then Value is LOW");
+	//attempt to arm secondary heroes is not stupid
+	addRule(engine, rules, "if strengthRatio is LOW and heroStrength is MEDIUM then Value is HIGH");
+	addRule(engine, rules, "if strengthRatio is LOW and heroStrength is HIGH then Value is LOW");
+
+	//do not cancel important goals
+	addRule(engine, rules, "if lockedMissionImportance is HIGH then Value is LOW");
+	addRule(engine, rules, "if lockedMissionImportance is MEDIUM then Value is MEDIUM");
+	addRule(engine, rules, "if lockedMissionImportance is LOW then Value is HIGH");
+	//pick nearby objects if it's easy, avoid long walks
+	addRule(engine, rules, "if turnDistance is SHORT then Value is HIGH");
+	addRule(engine, rules, "if turnDistance is MEDIUM then Value is MEDIUM");
+	addRule(engine, rules, "if turnDistance is LONG then Value is LOW");
+
+	return vars;
+}
+
+fl::InputVariable * addObjectValueRules(fl::Engine & engine, fl::RuleBlock & rules)
+{
+	auto objectValue = new fl::InputVariable("objectValue"); //value of that object type known by AI
+
+	engine.addInputVariable(objectValue);
+
+	//objectValue ranges are based on checking RMG priorities of some objects and checking LOW/MID/HIGH proportions for various values in QtFuzzyLite
+	objectValue->addTerm(new fl::Ramp("LOW", 3500.0, 0.0));
+	objectValue->addTerm(new fl::Triangle("MEDIUM", 0.0, 8500.0));
+	std::vector<fl::Discrete::Pair> multiRamp = { fl::Discrete::Pair(5000.0, 0.0), fl::Discrete::Pair(10000.0, 0.75), fl::Discrete::Pair(20000.0, 1.0) };
+	objectValue->addTerm(new fl::Discrete("HIGH", multiRamp));
+	objectValue->setRange(0.0, 20000.0); //relic artifact value is border value by design, even better things are scaled down.
+
+	addRule(engine, rules, "if objectValue is HIGH then Value is HIGH");
+	addRule(engine, rules, "if objectValue is MEDIUM then Value is MEDIUM");
+	addRule(engine, rules, "if objectValue is LOW then Value is LOW");
+
+	return objectValue;
+}
@@ -0,0 +1,36 @@
+/*
+* FuzzyGoalRules.h, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#pragma once
+#include "fl/Headers.h"
+
+/// Variables of hero movement goal engines, created with "new" and owned by engine they were added to
+struct HeroMovementGoalVariables
+{
+	fl::InputVariable * strengthRatio; //hero must be strong enough to defeat guards
+	fl::InputVariable * heroStrength; //we want to use weakest possible hero
+	fl::InputVariable * turnDistance; //we want to use hero who is near
+	fl::InputVariable * missionImportance; //we may want to preempt hero with low-priority mission
+	fl::OutputVariable * value;
+};
+
+/// Terms and rules of goal engines live apart from engine classes, which need AI state to evaluate goals,
+/// so they can be checked on their own
+
+/// operators used by all AI fuzzy engines
+void configureFuzzyEngine(fl::Engine & engine);
+/// variables and rules shared by VisitTileEngine and VisitObjEngine
+HeroMovementGoalVariables addHeroMovementGoalRules(fl::Engine & engine, fl::RuleBlock & rules, double safeAttackRatio);
+/// object value variable and rules of VisitObjEngine
+fl::InputVariable * addObjectValueRules(fl::Engine & engine, fl::RuleBlock & rules);
+
+/// lookup table grid density of engine inputs in order they were added, see FuzzyLookupTable::build
+/// strengthRatio and heroStrength meet in conjunctions, which bend the output more than other inputs
+extern const std::vector<int> VISIT_TILE_TABLE_SUBDIVISIONS;
+extern const std::vector<int> VISIT_OBJ_TABLE_SUBDIVISIONS;
@@ -0,0 +1,217 @@
+/*
+* FuzzyLookupTable.cpp, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#include "StdInc.h"
+#include "FuzzyLookupTable.h"
+
+const size_t FuzzyLookupTable::MAX_INPUTS;
+
+namespace
+{
+	//points where membership function of term changes its slope
+	//and points where it jumps (rectangle edges), grid gets extra points next to them so jump is not spread over whole grid cell
+	void addBreakPoints(std::vector<fl::scalar> & points, std::vector<fl::scalar> & jumps, const fl::Term * term)
+	{
+		if(auto ramp = dynamic_cast<const fl::Ramp *>(term))
+		{
+			points.push_back(ramp->getStart());
+			points.push_back(ramp->getEnd());
+		}
+		else if(auto triangle = dynamic_cast<const fl::Triangle *>(term))
+		{
+			points.push_back(triangle->getVertexA());
+			points.push_back(triangle->getVertexB());
+			points.push_back(triangle->getVertexC());
+		}
+		else if(auto trapezoid = dynamic_cast<const fl::Trapezoid *>(term))
+		{
+			points.push_back(trapezoid->getVertexA());
+			points.push_back(trapezoid->getVertexB());
+			points.push_back(trapezoid->getVertexC());
+			points.push_back(trapezoid->getVertexD());
+		}
+		else if(auto rectangle = dynamic_cast<const fl::Rectangle *>(term))
+		{
+			points.push_back(rectangle->getStart());
+			points.push_back(rectangle->getEnd());
+			jumps.push_back(rectangle->getStart());
+			jumps.push_back(rectangle->getEnd());
+		}
+		else if(auto discrete = dynamic_cast<const fl::Discrete *>(term))
+		{
+			for(auto & pair : discrete->xy())
+				points.push_back(pair.first);
+		}
+	}
+}
+
+FuzzyLookupTable::FuzzyLookupTable()
+{
+}
+
+std::vector<fl::scalar> FuzzyLookupTable::makeAxis(const fl::InputVariable * input, int subdivisions)
+{
+	const fl::scalar minimum = input->getMinimum();
+	const fl::scalar maximum = input->getMaximum();
+
+	std::vector<fl::scalar> breakPoints = {minimum, maximum};
+	std::vector<fl::scalar> jumps;
+	for(auto term : input->terms())
+		addBreakPoints(breakPoints, jumps, term);
+
+	auto normalize = [=](std::vector<fl::scalar> & points)
+	{
+		vstd::erase_if(points, [=](fl::scalar x)
+		{
+			return fl::Op::isNaN(x) || x < minimum || x > maximum;
+		});
+		std::sort(points.begin(), points.end());
+		points.erase(std::unique(points.begin(), points.end(), [](fl::scalar a, fl::scalar b)
+		{
+			return fl::Op::isEq(a, b);
+		}), points.end());
+	};
+
+	normalize(breakPoints);
+	std::vector<fl::scalar> axis;
+	for(size_t i = 0; i + 1 < breakPoints.size(); i++)
+	{
+		for(int part = 0; part < subdivisions; part++)
+			axis.push_back(breakPoints[i] + (breakPoints[i + 1] - breakPoints[i]) * part / subdivisions);
+	}
+	axis.push_back(breakPoints.back());
+
+	const fl::scalar margin = (maximum - minimum) * 1e-4;
+	for(fl::scalar jump : jumps)
+	{
+		axis.push_back(jump - margin);
+		axis.push_back(jump + margin);
+	}
+	normalize(axis);
+
+	return axis;
+}
+
+void FuzzyLookupTable::build(fl::Engine & engine, const std::vector<fl::InputVariable *> & sampledInputs, const fl::OutputVariable * output, const std::vector<int> & subdivisions)
+{
+	assert(sampledInputs.size() <= MAX_INPUTS);
+	assert(subdivisions.size() == sampledInputs.size());
+
+	inputs.assign(sampledInputs.begin(), sampledInputs.end());
+	axes.clear();
+	strides.clear();
+	samples.clear();
+
+	size_t total = 1;
+	for(size_t i = 0; i < inputs.size(); i++)
+	{
+		assert(subdivisions[i] > 0);
+		axes.push_back(makeAxis(inputs[i], subdivisions[i]));
+		total *= axes.back().size();
+	}
+
+	//last input changes fastest
+	strides.resize(inputs.size());
+	size_t stride = 1;
+	for(size_t i = inputs.size(); i-- > 0;)
+	{
+		strides[i] = stride;
+		stride *= axes[i].size();
+	}
+
+	std::vector<fl::scalar> currentValues;
+	for(auto input : sampledInputs)
+		currentValues.push_back(input->getValue());
+
+	samples.resize(total);
+	std::vector<size_t> point(inputs.size(), 0);
+	for(size_t index = 0; index < total; index++)
+	{
+		for(size_t i = 0; i < inputs.size(); i++)
+			sampledInputs[i]->setValue(axes[i][point[i]]);
+
+		engine.process();
+		samples[index] = output->getValue();
+
+		for(size_t i = inputs.size(); i-- > 0;)
+		{
+			if(++point[i] < axes[i].size())
+				break;
+			point[i] = 0;
+		}
+	}
+
+	for(size_t i = 0; i < sampledInputs.size(); i++)
+		sampledInputs[i]->setValue(currentValues[i]);
+}
+
+bool FuzzyLookupTable::isBuilt() const
+{
+	return !samples.empty();
+}
+
+size_t FuzzyLookupTable::size() const
+{
+	return samples.size();
+}
+
+fl::scalar FuzzyLookupTable::evaluate() const
+{
+	assert(isBuilt());
+
+	size_t base = 0;
+	fl::scalar fraction[MAX_INPUTS];
+	const size_t dimensions = inputs.size();
+
+	for(size_t d = 0; d < dimensions; d++)
+	{
+		const auto & axis = axes[d];
+		fl::scalar value = inputs[d]->getValue();
+		vstd::amax(value, axis.front());
+		vstd::amin(value, axis.back());
+
+		size_t segment = 0;
+		if(axis.size() > 1)
+		{
+			segment = std::upper_bound(axis.begin(), axis.end(), value) - axis.begin();
+			vstd::amin(segment, axis.size() - 1);
+			segment--;
+			fraction[d] = (value - axis[segment]) / (axis[segment + 1] - axis[segment]);
+		}
+		else
+		{
+			fraction[d] = 0;
+		}
+
+		base += segment * strides[d];
+	}
+
+	//weighted sum over corners of grid cell containing the point
+	fl::scalar result = 0;
+	for(size_t corner = 0; corner < (size_t(1) << dimensions); corner++)
+	{
+		fl::scalar weight = 1;
+		size_t index = base;
+		for(size_t i = 0; i < dimensions; i++)
+		{
+			if(corner & (size_t(1) << i))
+			{
+				weight *= fraction[i];
+				index += strides[i];
+			}
+			else
+			{
+				weight *= 1 - fraction[i];
+			}
+		}
+		if(weight > 0)
+			result += weight * samples[index];
+	}
+	return result;
+}
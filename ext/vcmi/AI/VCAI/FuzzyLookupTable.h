@@ -0,0 +1,41 @@
+/*
+* FuzzyLookupTable.h, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#pragma once
+#include "fl/Headers.h"
+
+/// Output of fuzzy engine sampled on a grid of input values and evaluated by multilinear interpolation.
+/// Inference with centroid defuzzification is costly, while inputs and rules do not change after engine is configured.
+/// Grid contains all break points of input terms, so interpolation error comes only from nonlinearity of defuzzification
+class FuzzyLookupTable
+{
+public:
+	static const size_t MAX_INPUTS = 8;
+
+	FuzzyLookupTable();
+
+	/// samples output of configured engine for all grid points, inputs that are not listed keep their current values
+	/// values of sampled inputs are restored afterwards
+	/// every interval between neighbouring break points of input terms is divided into number of parts given for that input
+	void build(fl::Engine & engine, const std::vector<fl::InputVariable *> & sampledInputs, const fl::OutputVariable * output, const std::vector<int> & subdivisions);
+	bool isBuilt() const;
+	/// number of sampled grid points
+	size_t size() const;
+
+	/// output for current values of inputs given to build(), values outside of input range are clamped to it
+	fl::scalar evaluate() const;
+
+private:
+	std::vector<const fl::InputVariable *> inputs;
+	std::vector<std::vector<fl::scalar>> axes; //grid coordinates for each input
+	std::vector<size_t> strides;
+	std::vector<fl::scalar> samples;
+
+	static std::vector<fl::scalar> makeAxis(const fl::InputVariable * input, int subdivisions);
+};
@@ -10,14 +10,19 @@
 #include "StdInc.h"
 #include "AIPathfinder.h"
 #include "AIPathfinderConfig.h"
+#include "../VCAI.h"
 #include "../../../CCallback.h"
+#include "../../../lib/CThreadHelper.h"
 
-std::vector<std::shared_ptr<AINodeStorage>> AIPathfinder::storagePool;
-std::map<HeroPtr, std::shared_ptr<AINodeStorage>> AIPathfinder::storageMap;
-boost::mutex AIPathfinder::storageMutex;
+extern boost::thread_specific_ptr<VCAI> ai;
+
+AIPathfinder::StorageSlot::StorageSlot(std::shared_ptr<AINodeStorage> nodeStorage)
+	:nodeStorage(nodeStorage), hero(nullptr), generation(0)
+{
+}
 
 AIPathfinder::AIPathfinder(CPlayerSpecificInfoCallback * cb)
-	:cb(cb)
+	:storageGeneration(0), cb(cb)
 {
 }
 
@@ -25,38 +30,123 @@ void AIPathfinder::clear()
 {
 	boost::unique_lock<boost::mutex> storageLock(storageMutex);
 	storageMap.clear();
+	storageGeneration++;
 }
 
-std::vector<AIPath> AIPathfinder::getPathInfo(HeroPtr hero, int3 tile)
+std::shared_ptr<AIPathfinder::StorageSlot> AIPathfinder::getStorageSlot(HeroPtr hero, ui32 & generation)
 {
 	boost::unique_lock<boost::mutex> storageLock(storageMutex);
-	std::shared_ptr<AINodeStorage> nodeStorage;
+	std::shared_ptr<StorageSlot> slot;
+
+	generation = storageGeneration;
+
+	auto it = storageMap.find(hero);
+
+	if(it != storageMap.end())
+		return it->second;
+
+	if(storageMap.size() < storagePool.size())
+	{
+		slot = storagePool.at(storageMap.size());
+	}
+	else
+	{
+		slot = std::make_shared<StorageSlot>(std::make_shared<AINodeStorage>(cb->getMapSize()));
+		storagePool.push_back(slot);
+	}
+
+	storageMap[hero] = slot;
+
+	return slot;
+}
+
+void AIPathfinder::calculatePaths(const CGHeroInstance * hero, std::shared_ptr<StorageSlot> slot, ui32 generation)
+{
+	// caller must hold slot->sync
+	if(slot->hero == hero && slot->generation == generation)
+		return;
+
+	logAi->debug("Recalculate paths for %s", hero->name);
+
+	auto config = std::make_shared<AIPathfinderConfig>(cb, slot->nodeStorage);
+
+	slot->nodeStorage->setHero(hero);
+	cb->calculatePaths(config, hero);
+
+	slot->hero = hero;
+	slot->generation = generation;
+}
 
-	if(!vstd::contains(storageMap, hero))
+std::vector<AIPath> AIPathfinder::getPathInfo(HeroPtr hero, int3 tile)
+{
+	ui32 generation;
+	auto slot = getStorageSlot(hero, generation);
+
+	boost::unique_lock<boost::mutex> slotLock(slot->sync);
+
+	calculatePaths(hero.get(), slot, generation);
+
+	return slot->nodeStorage->getChainInfo(tile);
+}
+
+void AIPathfinder::updatePaths(std::vector<HeroPtr> heroes)
+{
+	std::vector<Task> tasks;
+	std::vector<std::exception_ptr> errors(heroes.size());
+
+	// danger of guarded tiles is evaluated through thread-specific AI state, workers need the same one
+	VCAI * currentAI = ai.get();
+
+	for(HeroPtr hero : heroes)
 	{
-		logAi->debug("Recalculate paths for %s", hero->name);
+		ui32 generation;
+		auto slot = getStorageSlot(hero, generation);
+
+		// HeroPtr::get relies on thread-specific callback so resolve heroes here
+		const CGHeroInstance * h = hero.get();
 
-		if(storageMap.size() < storagePool.size())
 		{
-			nodeStorage = storagePool.at(storageMap.size());
+			boost::unique_lock<boost::mutex> slotLock(slot->sync);
+
+			if(slot->hero == h && slot->generation == generation)
+				continue;
 		}
-		else
+
+		auto error = &errors[tasks.size()];
+
+		tasks.push_back([this, h, slot, generation, currentAI, error]()
 		{
-			nodeStorage = std::make_shared<AINodeStorage>(cb->getMapSize());
-			storagePool.push_back(nodeStorage);
-		}
+			try
+			{
+				std::unique_ptr<SetGlobalState> state;
+				if(currentAI)
+					state = make_unique<SetGlobalState>(currentAI);
 
-		storageMap[hero] = nodeStorage;
-		
-		auto config = std::make_shared<AIPathfinderConfig>(cb, nodeStorage);
+				boost::unique_lock<boost::mutex> slotLock(slot->sync);
 
-		nodeStorage->setHero(hero.get());
-		cb->calculatePaths(config, hero.get());
+				calculatePaths(h, slot, generation);
+			}
+			catch(...)
+			{
+				*error = std::current_exception();
+			}
+		});
 	}
-	else
+
+	if(tasks.empty())
+		return;
+
+	uint32_t threadCount = boost::thread::hardware_concurrency();
+
+	vstd::amin(threadCount, tasks.size());
+	vstd::amax(threadCount, 1);
+
+	CThreadHelper threadHelper(&tasks, threadCount);
+	threadHelper.run();
+
+	for(auto & error : errors)
 	{
-		nodeStorage = storageMap.at(hero);
+		if(error)
+			std::rethrow_exception(error);
 	}
-
-	return nodeStorage->getChainInfo(tile);
-}
\ No newline at end of file
+}
@@ -16,13 +16,31 @@
 class AIPathfinder
 {
 private:
-	static std::vector<std::shared_ptr<AINodeStorage>> storagePool;
-	static std::map<HeroPtr, std::shared_ptr<AINodeStorage>> storageMap;
-	static boost::mutex storageMutex;
+	/// Pooled node storage together with the lock guarding its contents
+	struct StorageSlot
+	{
+		std::shared_ptr<AINodeStorage> nodeStorage;
+		boost::mutex sync;
+		const CGHeroInstance * hero; //hero whose paths are currently stored
+		ui32 generation; //value of storageGeneration when paths were calculated
+
+		StorageSlot(std::shared_ptr<AINodeStorage> nodeStorage);
+	};
+
+	/// Storages belong to this pathfinder so heroes of different AI players never share them
+	std::vector<std::shared_ptr<StorageSlot>> storagePool;
+	std::map<HeroPtr, std::shared_ptr<StorageSlot>> storageMap;
+	boost::mutex storageMutex; //guards storagePool, storageMap and storageGeneration only
+	ui32 storageGeneration;
 	CPlayerSpecificInfoCallback * cb;
 
+	std::shared_ptr<StorageSlot> getStorageSlot(HeroPtr hero, ui32 & generation);
+	void calculatePaths(const CGHeroInstance * hero, std::shared_ptr<StorageSlot> slot, ui32 generation);
+
 public:
 	AIPathfinder(CPlayerSpecificInfoCallback * cb);
 	std::vector<AIPath> getPathInfo(HeroPtr hero, int3 tile);
+	/// Calculates paths of given heroes with outdated storage concurrently, each hero in its own storage
+	void updatePaths(std::vector<HeroPtr> heroes);
 	void clear();
 };
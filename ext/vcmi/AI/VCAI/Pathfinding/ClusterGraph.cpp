@@ -0,0 +1,476 @@
+/*
+* ClusterGraph.cpp, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#include "StdInc.h"
+#include "ClusterGraph.h"
+#include "../../../lib/CGameInfoCallback.h"
+#include "../../../lib/mapping/CMap.h"
+#include "../../../lib/mapObjects/MapObjects.h"
+
+namespace
+{
+	const ui32 TILE_COST = 100;
+
+	ui32 estimateDistance(const int3 & src, const int3 & dst)
+	{
+		return std::max(std::abs(src.x - dst.x), std::abs(src.y - dst.y)) * TILE_COST;
+	}
+}
+
+ClusterGraph::Cluster::Cluster()
+	:dirty(true)
+{
+}
+
+ClusterGraph::ClusterGraph(CPlayerSpecificInfoCallback * cb)
+	:cb(cb), specialLinksValid(false)
+{
+	mapSize = cb->getMapSize();
+	clustersCount = int3(
+		(mapSize.x + CLUSTER_SIZE - 1) / CLUSTER_SIZE,
+		(mapSize.y + CLUSTER_SIZE - 1) / CLUSTER_SIZE,
+		mapSize.z);
+
+	clusters.resize(clustersCount.x * clustersCount.y * clustersCount.z);
+	tileComponents.resize(boost::extents[mapSize.x][mapSize.y][mapSize.z]);
+	std::fill(tileComponents.data(), tileComponents.data() + tileComponents.num_elements(), -1);
+}
+
+void ClusterGraph::invalidateTiles(const std::vector<int3> & tiles)
+{
+	boost::unique_lock<boost::mutex> lock(sync);
+
+	for(const int3 & tile : tiles)
+	{
+		if(cb->isInTheMap(tile))
+			clusters[getClusterIndex(tile)].dirty = true;
+	}
+}
+
+void ClusterGraph::invalidate()
+{
+	boost::unique_lock<boost::mutex> lock(sync);
+
+	for(Cluster & cluster : clusters)
+		cluster.dirty = true;
+}
+
+void ClusterGraph::invalidateLinks()
+{
+	boost::unique_lock<boost::mutex> lock(sync);
+
+	specialLinksValid = false;
+}
+
+bool ClusterGraph::isConnected(const int3 & src, const int3 & dst)
+{
+	return estimateCost(src, dst).is_initialized();
+}
+
+boost::optional<ui32> ClusterGraph::estimateCost(const int3 & src, const int3 & dst)
+{
+	boost::unique_lock<boost::mutex> lock(sync);
+
+	update();
+
+	auto srcNode = getNode(src);
+	auto dstNode = getNode(dst);
+
+	if(!srcNode || !dstNode)
+		return boost::none;
+
+	if(srcNode == dstNode)
+		return estimateDistance(src, dst);
+
+	ui32 cost = getCosts(srcNode.get())[getNodeIndex(dstNode.get())];
+
+	if(cost == std::numeric_limits<ui32>::max())
+		return boost::none;
+
+	return estimateDistance(src, getComponent(srcNode.get()).center) + cost + estimateDistance(getComponent(dstNode.get()).center, dst);
+}
+
+const std::vector<ui32> & ClusterGraph::getCosts(const TNodeID & src)
+{
+	auto cached = costCache.find(src);
+
+	if(cached != costCache.end())
+		return cached->second;
+
+	typedef std::pair<ui32, size_t> TQueueItem;
+
+	std::vector<TNodeID> nodes(clusterOffsets.back());
+
+	for(size_t i = 0; i < clusters.size(); i++)
+	{
+		for(size_t j = 0; j < clusters[i].components.size(); j++)
+			nodes[clusterOffsets[i] + j] = TNodeID(i, j);
+	}
+
+	std::vector<ui32> & costs = costCache[src];
+	std::priority_queue<TQueueItem, std::vector<TQueueItem>, std::greater<TQueueItem>> queue;
+
+	costs.resize(nodes.size(), std::numeric_limits<ui32>::max());
+	costs[getNodeIndex(src)] = 0;
+	queue.push(std::make_pair(0, getNodeIndex(src)));
+
+	while(!queue.empty())
+	{
+		ui32 cost = queue.top().first;
+		size_t index = queue.top().second;
+
+		queue.pop();
+
+		if(cost > costs[index])
+			continue;
+
+		auto visitLink = [&](const std::pair<TNodeID, ui32> & link)
+		{
+			ui32 linkCost = cost + link.second;
+			size_t linkIndex = getNodeIndex(link.first);
+
+			if(costs[linkIndex] > linkCost)
+			{
+				costs[linkIndex] = linkCost;
+				queue.push(std::make_pair(linkCost, linkIndex));
+			}
+		};
+
+		for(auto & link : getComponent(nodes[index]).links)
+			visitLink(link);
+
+		auto special = specialLinks.find(nodes[index]);
+
+		if(special != specialLinks.end())
+		{
+			for(auto & link : special->second)
+				visitLink(link);
+		}
+	}
+
+	return costs;
+}
+
+int ClusterGraph::getClusterIndex(const int3 & tile) const
+{
+	return (tile.z * clustersCount.y + tile.y / CLUSTER_SIZE) * clustersCount.x + tile.x / CLUSTER_SIZE;
+}
+
+boost::optional<ClusterGraph::TNodeID> ClusterGraph::getNode(const int3 & tile) const
+{
+	if(!cb->isInTheMap(tile))
+		return boost::none;
+
+	si16 component = tileComponents[tile.x][tile.y][tile.z];
+
+	if(component < 0)
+		return boost::none;
+
+	return TNodeID(getClusterIndex(tile), component);
+}
+
+const ClusterGraph::Component & ClusterGraph::getComponent(const TNodeID & node) const
+{
+	return clusters[node.first].components[node.second];
+}
+
+size_t ClusterGraph::getNodeIndex(const TNodeID & node) const
+{
+	return clusterOffsets[node.first] + node.second;
+}
+
+const TerrainTile * ClusterGraph::getPassableTile(const int3 & tile) const
+{
+	const TerrainTile * t = cb->getTile(tile, false);
+
+	if(!t || t->terType == ETerrainType::ROCK || (t->blocked && !t->visitable))
+		return nullptr;
+
+	return t;
+}
+
+void ClusterGraph::update()
+{
+	std::set<int> rebuiltClusters;
+
+	for(size_t i = 0; i < clusters.size(); i++)
+	{
+		if(clusters[i].dirty)
+			rebuiltClusters.insert(i);
+	}
+
+	if(rebuiltClusters.empty() && specialLinksValid)
+		return;
+
+	std::set<int> relinkedClusters;
+
+	for(int i : rebuiltClusters)
+	{
+		buildComponents(i);
+
+		// links of neighbour clusters may point to components which no longer exist
+		int x = i % clustersCount.x;
+		int y = i / clustersCount.x % clustersCount.y;
+		int z = i / (clustersCount.x * clustersCount.y);
+
+		for(int dx = -1; dx <= 1; dx++)
+		{
+			for(int dy = -1; dy <= 1; dy++)
+			{
+				if(x + dx >= 0 && x + dx < clustersCount.x && y + dy >= 0 && y + dy < clustersCount.y)
+					relinkedClusters.insert((z * clustersCount.y + y + dy) * clustersCount.x + x + dx);
+			}
+		}
+	}
+
+	for(int i : relinkedClusters)
+		buildLinks(i);
+
+	buildSpecialLinks();
+
+	clusterOffsets.assign(1, 0);
+	for(const Cluster & cluster : clusters)
+		clusterOffsets.push_back(clusterOffsets.back() + cluster.components.size());
+
+	costCache.clear();
+
+	logAi->trace("Cluster graph updated, %d clusters rebuilt", rebuiltClusters.size());
+}
+
+void ClusterGraph::buildComponents(int clusterIndex)
+{
+	Cluster & cluster = clusters[clusterIndex];
+
+	int3 origin(
+		clusterIndex % clustersCount.x * CLUSTER_SIZE,
+		clusterIndex / clustersCount.x % clustersCount.y * CLUSTER_SIZE,
+		clusterIndex / (clustersCount.x * clustersCount.y));
+	int3 end(
+		std::min(origin.x + CLUSTER_SIZE, mapSize.x),
+		std::min(origin.y + CLUSTER_SIZE, mapSize.y),
+		origin.z);
+
+	auto isInCluster = [&](const int3 & tile) -> bool
+	{
+		return tile.x >= origin.x && tile.x < end.x && tile.y >= origin.y && tile.y < end.y && tile.z == origin.z;
+	};
+
+	cluster.dirty = false;
+	cluster.components.clear();
+	cluster.teleports.clear();
+	cluster.shipyards.clear();
+
+	for(int x = origin.x; x < end.x; x++)
+	{
+		for(int y = origin.y; y < end.y; y++)
+			tileComponents[x][y][origin.z] = -1;
+	}
+
+	for(int x = origin.x; x < end.x; x++)
+	{
+		for(int y = origin.y; y < end.y; y++)
+		{
+			int3 start(x, y, origin.z);
+			const TerrainTile * startTile = getPassableTile(start);
+
+			if(!startTile || tileComponents[x][y][origin.z] >= 0)
+				continue;
+
+			si16 componentIndex = cluster.components.size();
+			Component component;
+			int3 sum;
+			int count = 0;
+
+			component.water = startTile->isWater();
+
+			std::queue<int3> toVisit;
+
+			tileComponents[x][y][origin.z] = componentIndex;
+			toVisit.push(start);
+
+			while(!toVisit.empty())
+			{
+				int3 tile = toVisit.front();
+				toVisit.pop();
+
+				sum += tile;
+				count++;
+
+				for(const CGObjectInstance * obj : cb->getTile(tile, false)->visitableObjects)
+				{
+					if(CGTeleport::isTeleport(obj) && dynamic_cast<const CGTeleport *>(obj)->isEntrance())
+						cluster.teleports.push_back(tile);
+
+					if(IShipyard::castFrom(obj))
+						cluster.shipyards.push_back(tile);
+				}
+
+				for(const int3 & dir : int3::getDirs())
+				{
+					int3 neighbour = tile + dir;
+
+					if(!isInCluster(neighbour) || tileComponents[neighbour.x][neighbour.y][neighbour.z] >= 0)
+						continue;
+
+					const TerrainTile * neighbourTile = getPassableTile(neighbour);
+
+					if(neighbourTile && neighbourTile->isWater() == component.water)
+					{
+						tileComponents[neighbour.x][neighbour.y][neighbour.z] = componentIndex;
+						toVisit.push(neighbour);
+					}
+				}
+			}
+
+			component.center = int3(sum.x / count, sum.y / count, origin.z);
+			cluster.components.push_back(component);
+		}
+	}
+
+	vstd::removeDuplicates(cluster.teleports);
+	vstd::removeDuplicates(cluster.shipyards);
+}
+
+void ClusterGraph::buildLinks(int clusterIndex)
+{
+	Cluster & cluster = clusters[clusterIndex];
+	std::vector<std::map<TNodeID, ui32>> links(cluster.components.size());
+
+	int3 origin(
+		clusterIndex % clustersCount.x * CLUSTER_SIZE,
+		clusterIndex / clustersCount.x % clustersCount.y * CLUSTER_SIZE,
+		clusterIndex / (clustersCount.x * clustersCount.y));
+
+	for(int x = origin.x; x < std::min(origin.x + CLUSTER_SIZE, mapSize.x); x++)
+	{
+		for(int y = origin.y; y < std::min(origin.y + CLUSTER_SIZE, mapSize.y); y++)
+		{
+			int3 tile(x, y, origin.z);
+			auto node = getNode(tile);
+
+			if(!node)
+				continue;
+
+			const Component & component = getComponent(node.get());
+
+			for(const int3 & dir : int3::getDirs())
+			{
+				int3 neighbour = tile + dir;
+				auto neighbourNode = getNode(neighbour);
+
+				if(!neighbourNode || neighbourNode == node)
+					continue;
+
+				const Component & neighbourComponent = getComponent(neighbourNode.get());
+
+				if(neighbourComponent.water != component.water
+					&& !canBeEmbarkmentPoint(cb->getTile(neighbour, false), component.water))
+				{
+					continue;
+				}
+
+				ui32 cost = std::max(estimateDistance(component.center, neighbourComponent.center), TILE_COST);
+				auto & linkCost = links[node->second][neighbourNode.get()];
+
+				if(linkCost == 0 || linkCost > cost)
+					linkCost = cost;
+			}
+		}
+	}
+
+	for(size_t i = 0; i < cluster.components.size(); i++)
+	{
+		cluster.components[i].links.assign(links[i].begin(), links[i].end());
+	}
+}
+
+void ClusterGraph::buildSpecialLinks()
+{
+	specialLinks.clear();
+
+	for(const Cluster & cluster : clusters)
+	{
+		for(const int3 & entrance : cluster.teleports)
+		{
+			auto entranceNode = getNode(entrance);
+
+			if(!entranceNode)
+				continue;
+
+			for(const CGObjectInstance * obj : cb->getTile(entrance, false)->visitableObjects)
+			{
+				auto teleport = dynamic_cast<const CGTeleport *>(obj);
+
+				if(!teleport)
+					continue;
+
+				for(auto exitId : cb->getTeleportChannelExits(teleport->channel, cb->getMyColor().get()))
+				{
+					auto exit = cb->getObj(exitId, false);
+					auto exitNode = exit ? getNode(exit->visitablePos()) : boost::none;
+
+					if(exitNode && exitNode != entranceNode)
+						specialLinks[entranceNode.get()].push_back(std::make_pair(exitNode.get(), TILE_COST));
+				}
+			}
+		}
+	}
+
+	// water reachable only by buying a boat is connected to shipyard, boat cost is not checked
+	for(const Cluster & cluster : clusters)
+	{
+		for(const int3 & shipyardPos : cluster.shipyards)
+		{
+			auto shipyardNode = getNode(shipyardPos);
+
+			if(!shipyardNode)
+				continue;
+
+			for(const CGObjectInstance * obj : cb->getTile(shipyardPos, false)->visitableObjects)
+			{
+				auto shipyard = IShipyard::castFrom(obj);
+
+				if(!shipyard || (obj->ID == Obj::TOWN && !static_cast<const CGTownInstance *>(obj)->hasBuilt(BuildingID::SHIPYARD)))
+					continue;
+
+				std::vector<int3> offsets;
+				shipyard->getOutOffsets(offsets);
+
+				for(const int3 & offset : offsets)
+				{
+					auto boatNode = getNode(obj->pos + offset);
+
+					if(boatNode && boatNode != shipyardNode && getComponent(boatNode.get()).water)
+						specialLinks[shipyardNode.get()].push_back(std::make_pair(boatNode.get(), TILE_COST));
+				}
+			}
+		}
+	}
+
+	std::vector<TNodeID> castleGates;
+
+	for(const CGTownInstance * town : cb->getTownsInfo())
+	{
+		auto townNode = getNode(town->visitablePos());
+
+		if(townNode && town->hasBuilt(BuildingID::CASTLE_GATE))
+			castleGates.push_back(townNode.get());
+	}
+
+	for(const TNodeID & src : castleGates)
+	{
+		for(const TNodeID & dst : castleGates)
+		{
+			if(src != dst)
+				specialLinks[src].push_back(std::make_pair(dst, TILE_COST));
+		}
+	}
+
+	specialLinksValid = true;
+}
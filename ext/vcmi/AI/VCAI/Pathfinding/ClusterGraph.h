@@ -0,0 +1,83 @@
+/*
+* ClusterGraph.h, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+
+#pragma once
+
+#include "../AIUtility.h"
+
+/// Cluster abstraction of adventure map used to reject unreachable goals without full tile search.
+/// Map is split into square clusters and each cluster into connected components of passable land
+/// or water tiles. Components are linked through cluster borders, embarkation points, shipyards,
+/// teleports and castle gates.
+/// Graph is optimistic - if there is no abstract route then walking, sailing and teleporting hero
+/// can't reach destination either. Flying and water walking are not taken into account.
+/// It only prunes queries, abstract routes are not refined into paths.
+/// Costs from each source component are cached until the graph changes.
+class ClusterGraph
+{
+public:
+	static const int CLUSTER_SIZE = 16;
+
+	ClusterGraph(CPlayerSpecificInfoCallback * cb);
+
+	/// Marks clusters containing given tiles for rebuild
+	void invalidateTiles(const std::vector<int3> & tiles);
+	/// Marks whole graph for rebuild
+	void invalidate();
+	/// Teleport, castle gate and shipyard links are rebuilt, clusters are kept
+	void invalidateLinks();
+
+	/// Estimated movement cost between tiles, none if tiles are not connected
+	boost::optional<ui32> estimateCost(const int3 & src, const int3 & dst);
+	bool isConnected(const int3 & src, const int3 & dst);
+
+private:
+	typedef std::pair<int, int> TNodeID; //cluster index, component index within cluster
+
+	struct Component
+	{
+		int3 center;
+		bool water;
+		std::vector<std::pair<TNodeID, ui32>> links; //neighbour components and cost to reach them
+	};
+
+	struct Cluster
+	{
+		bool dirty;
+		std::vector<Component> components;
+		std::vector<int3> teleports; //positions of teleport entrances inside cluster
+		std::vector<int3> shipyards; //positions of towns and shipyards which may build a boat
+
+		Cluster();
+	};
+
+	CPlayerSpecificInfoCallback * cb;
+	int3 mapSize;
+	int3 clustersCount;
+	boost::mutex sync;
+	std::vector<Cluster> clusters;
+	boost::multi_array<si16, 3> tileComponents; //component index within cluster or -1 if tile is impassable
+	std::map<TNodeID, std::vector<std::pair<TNodeID, ui32>>> specialLinks; //teleports, castle gates and shipyards
+	bool specialLinksValid;
+	std::vector<size_t> clusterOffsets; //index of first component of each cluster among all components
+	std::map<TNodeID, std::vector<ui32>> costCache; //costs from source component to all components
+
+	int getClusterIndex(const int3 & tile) const;
+	boost::optional<TNodeID> getNode(const int3 & tile) const;
+	const Component & getComponent(const TNodeID & node) const;
+	const TerrainTile * getPassableTile(const int3 & tile) const;
+	size_t getNodeIndex(const TNodeID & node) const;
+	const std::vector<ui32> & getCosts(const TNodeID & src);
+
+	void update();
+	void buildComponents(int clusterIndex);
+	void buildLinks(int clusterIndex);
+	void buildSpecialLinks();
+};
@@ -23,6 +23,7 @@ void PathfindingManager::setCB(CPlayerSpecificInfoCallback * CB)
 {
 	cb = CB;
 	pathfinder.reset(new AIPathfinder(cb));
+	clusterGraph.reset(new ClusterGraph(cb));
 }
 
 void PathfindingManager::setAI(VCAI * AI)
@@ -36,6 +37,11 @@ Goals::TGoalVec PathfindingManager::howToVisitTile(int3 tile)
 
 	auto heroes = cb->getHeroesInfo();
 
+	vstd::erase_if(heroes, [&](const CGHeroInstance * hero) -> bool
+	{
+		return !isTileConnected(hero, tile);
+	});
+
 	for(auto hero : heroes)
 	{
 		vstd::concatenate(result, howToVisitTile(hero, tile));
@@ -50,6 +56,11 @@ Goals::TGoalVec PathfindingManager::howToVisitObj(ObjectIdRef obj)
 
 	auto heroes = cb->getHeroesInfo();
 
+	vstd::erase_if(heroes, [&](const CGHeroInstance * hero) -> bool
+	{
+		return !obj || !isTileConnected(hero, obj->visitablePos());
+	});
+
 	for(auto hero : heroes)
 	{
 		vstd::concatenate(result, howToVisitObj(hero, obj));
@@ -99,6 +110,13 @@ Goals::TGoalVec PathfindingManager::findPath(
 	boost::optional<uint64_t> armyValueRequired;
 	uint64_t danger;
 
+	if(!isTileConnected(hero.get(), dest))
+	{
+		logAi->trace("Tile %s is not connected to %s position, skip path search", dest.toString(), hero->name);
+
+		return result;
+	}
+
 	std::vector<AIPath> chainInfo = pathfinder->getPathInfo(hero, dest);
 
 	logAi->trace("Trying to find a way for %s to visit tile %s", hero->name, dest.toString());
@@ -190,8 +208,30 @@ Goals::TSubgoal PathfindingManager::clearWayTo(HeroPtr hero, int3 firstTileToGet
 	return sptr(Goals::VisitTile(firstTileToGet).sethero(hero).setisAbstract(true));
 }
 
+void PathfindingManager::updatePaths(std::vector<HeroPtr> heroes)
+{
+	pathfinder->updatePaths(heroes);
+}
+
+void PathfindingManager::invalidateTiles(const std::vector<int3> & tiles)
+{
+	clusterGraph->invalidateTiles(tiles);
+}
+
 void PathfindingManager::resetPaths()
 {
 	logAi->debug("AIPathfinder has been reseted.");
 	pathfinder->clear();
+	clusterGraph->invalidateLinks();
+}
+
+bool PathfindingManager::isTileConnected(const CGHeroInstance * hero, int3 tile)
+{
+	// cluster graph does not know about flying and water walking so let full search decide
+	static const auto selector = Selector::type(Bonus::FLYING_MOVEMENT).Or(Selector::type(Bonus::WATER_WALKING));
+
+	if(hero->hasBonus(selector))
+		return true;
+
+	return clusterGraph->isConnected(hero->visitablePos(), tile);
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 
 #include "VCAI.h"
 #include "AINodeStorage.h"
+#include "ClusterGraph.h"
 
 class IPathfindingManager
 {
@@ -26,6 +27,8 @@ public:
 	virtual Goals::TGoalVec howToVisitTile(int3 tile) = 0;
 	virtual Goals::TGoalVec howToVisitObj(ObjectIdRef obj) = 0;
 	virtual std::vector<AIPath> getPathsToTile(HeroPtr hero, int3 tile) = 0;
+	virtual void updatePaths(std::vector<HeroPtr> heroes) = 0;
+	virtual void invalidateTiles(const std::vector<int3> & tiles) = 0;
 };
 	
 class PathfindingManager : public IPathfindingManager
@@ -36,6 +39,7 @@ private:
 	CPlayerSpecificInfoCallback * cb; //this is enough, but we downcast from CCallback
 	VCAI * ai;
 	std::unique_ptr<AIPathfinder> pathfinder;
+	std::unique_ptr<ClusterGraph> clusterGraph;
 
 public:
 	PathfindingManager() = default;
@@ -46,6 +50,8 @@ public:
 	Goals::TGoalVec howToVisitTile(int3 tile) override;
 	Goals::TGoalVec howToVisitObj(ObjectIdRef obj) override;
 	std::vector<AIPath> getPathsToTile(HeroPtr hero, int3 tile) override;
+	void updatePaths(std::vector<HeroPtr> heroes) override;
+	void invalidateTiles(const std::vector<int3> & tiles) override;
 	void resetPaths() override;
 
 private:
@@ -59,4 +65,5 @@ private:
 		const std::function<Goals::TSubgoal(int3)> goalFactory);
 
 	Goals::TSubgoal clearWayTo(HeroPtr hero, int3 firstTileToGet);
+	bool isTileConnected(const CGHeroInstance * hero, int3 tile);
 };
\ No newline at end of file
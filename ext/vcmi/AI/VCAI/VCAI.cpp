@@ -12,6 +12,7 @@
 #include "FuzzyHelper.h"
 #include "ResourceManager.h"
 #include "BuildingManager.h"
+#include "DangerHeatmap.h"
 
 #include "../../lib/UnlockGuard.h"
 #include "../../lib/mapObjects/MapObjects.h"
@@ -38,25 +39,22 @@ boost::thread_specific_ptr<VCAI> ai;
 
 //std::map<int, std::map<int, int> > HeroView::infosCount;
 
-//helper RAII to manage global ai/cb ptrs
-struct SetGlobalState
+SetGlobalState::SetGlobalState(VCAI * AI)
 {
-	SetGlobalState(VCAI * AI)
-	{
-		assert(!ai.get());
-		assert(!cb.get());
+	assert(!ai.get());
+	assert(!cb.get());
 
-		ai.reset(AI);
-		cb.reset(AI->myCb.get());
-	}
-	~SetGlobalState()
-	{
-		//TODO: how to handle rm? shouldn't be called after ai is destroyed, hopefully
-		//TODO: to ensure that, make rm unique_ptr
-		ai.release();
-		cb.release();
-	}
-};
+	ai.reset(AI);
+	cb.reset(AI->myCb.get());
+}
+
+SetGlobalState::~SetGlobalState()
+{
+	//TODO: how to handle rm? shouldn't be called after ai is destroyed, hopefully
+	//TODO: to ensure that, make rm unique_ptr
+	ai.release();
+	cb.release();
+}
 
 
 #define SET_GLOBAL_STATE(ai) SetGlobalState _hlpSetState(ai);
@@ -98,6 +96,8 @@ VCAI::VCAI()
 
 	ah = new AIhelper();
 	ah->setAI(this);
+
+	dangerHeatmap = make_unique<DangerHeatmap>();
 }
 
 VCAI::~VCAI()
@@ -124,6 +124,7 @@ void VCAI::heroMoved(const TryMoveHero & details)
 
 	const int3 from = CGHeroInstance::convertPosition(details.start, false);
 	const int3 to = CGHeroInstance::convertPosition(details.end, false);
+	dangerHeatmap->invalidate({from, to});
 	const CGObjectInstance * o1 = vstd::frontOrNull(cb->getVisitableObjs(from));
 	const CGObjectInstance * o2 = vstd::frontOrNull(cb->getVisitableObjs(to));
 
@@ -298,6 +299,8 @@ void VCAI::tileHidden(const std::unordered_set<int3, ShashInt3> & pos)
 	NET_EVENT_HANDLER;
 
 	validateVisitableObjs();
+	ah->invalidateTiles(std::vector<int3>(pos.begin(), pos.end()));
+	dangerHeatmap->invalidate(std::vector<int3>(pos.begin(), pos.end()));
 	clearPathsInfo();
 }
 
@@ -311,6 +314,8 @@ void VCAI::tileRevealed(const std::unordered_set<int3, ShashInt3> & pos)
 			addVisitableObj(obj);
 	}
 
+	ah->invalidateTiles(std::vector<int3>(pos.begin(), pos.end()));
+	dangerHeatmap->invalidate(std::vector<int3>(pos.begin(), pos.end()));
 	clearPathsInfo();
 }
 
@@ -392,6 +397,12 @@ void VCAI::garrisonsChanged(ObjectInstanceID id1, ObjectInstanceID id2)
 {
 	LOG_TRACE(logAi);
 	NET_EVENT_HANDLER;
+
+	for(auto id : {id1, id2})
+	{
+		if(auto obj = myCb->getObj(id, false))
+			dangerHeatmap->invalidate(obj);
+	}
 }
 
 void VCAI::newObject(const CGObjectInstance * obj)
@@ -401,6 +412,9 @@ void VCAI::newObject(const CGObjectInstance * obj)
 	if(obj->isVisitable())
 		addVisitableObj(obj);
 
+	auto blockedTiles = obj->getBlockedPos();
+	ah->invalidateTiles(std::vector<int3>(blockedTiles.begin(), blockedTiles.end()));
+	dangerHeatmap->invalidate(obj);
 	ah->resetPaths();
 }
 
@@ -460,6 +474,9 @@ void VCAI::objectRemoved(const CGObjectInstance * obj)
 		}
 	}
 
+	auto blockedTiles = obj->getBlockedPos();
+	ah->invalidateTiles(std::vector<int3>(blockedTiles.begin(), blockedTiles.end()));
+	dangerHeatmap->invalidate(obj);
 	ah->resetPaths();
 
 	//TODO
@@ -558,6 +575,14 @@ void VCAI::battleResultsApplied()
 	NET_EVENT_HANDLER;
 	assert(status.getBattle() == ENDING_BATTLE);
 	status.setBattle(NO_BATTLE);
+
+	//casualties of armies we don't own are not announced through garrisonsChanged
+	for(auto id : battleArmies)
+	{
+		if(auto obj = myCb->getObj(id, false))
+			dangerHeatmap->invalidate(obj);
+	}
+	battleArmies.clear();
 }
 
 void VCAI::objectPropertyChanged(const SetObjectProperty * sop)
@@ -566,6 +591,9 @@ void VCAI::objectPropertyChanged(const SetObjectProperty * sop)
 	NET_EVENT_HANDLER;
 	if(sop->what == ObjProperty::OWNER)
 	{
+		if(auto obj = myCb->getObj(sop->id, false))
+			dangerHeatmap->invalidate(obj); //owned and allied objects are not dangerous
+
 		if(myCb->getPlayerRelations(playerID, (PlayerColor)sop->val) == PlayerRelations::ENEMIES)
 		{
 			//we want to visit objects owned by oppponents
@@ -800,6 +828,9 @@ void VCAI::makeTurn()
 	boost::shared_lock<boost::shared_mutex> gsLock(CGameState::mutex);
 	setThreadName("VCAI::makeTurn");
 
+	//enemies moved and armies changed since our last turn
+	dangerHeatmap->invalidateAll();
+
 	switch(cb->getDate(Date::DAY_OF_WEEK))
 	{
 	case 1:
@@ -884,6 +915,9 @@ void VCAI::mainLoop()
 		elementarGoals.clear();
 		ultimateGoalsFromBasic.clear();
 
+		auto heroes = cb->getHeroesInfo();
+		ah->updatePaths(std::vector<HeroPtr>(heroes.begin(), heroes.end())); //warm up paths of all heroes at once
+
 		logAi->debug("Main loop: decomposing %i basic goals", basicGoals.size());
 
 		for (auto basicGoal : basicGoals)
@@ -1613,6 +1647,12 @@ void VCAI::battleStart(const CCreatureSet * army1, const CCreatureSet * army2, i
 	status.setBattle(ONGOING_BATTLE);
 	const CGObjectInstance * presumedEnemy = vstd::backOrNull(cb->getVisitableObjs(tile)); //may be nullptr in some very are cases -> eg. visited monolith and fighting with an enemy at the FoW covered exit
 	battlename = boost::str(boost::format("Starting battle of %s attacking %s at %s") % (hero1 ? hero1->name : "a army") % (presumedEnemy ? presumedEnemy->getObjectName() : "unknown enemy") % tile.toString());
+	battleArmies.clear();
+	for(auto army : {army1, army2})
+	{
+		if(auto obj = dynamic_cast<const CGObjectInstance *>(army))
+			battleArmies.push_back(obj->id);
+	}
 	CAdventureAI::battleStart(army1, army2, tile, hero1, hero2, side);
 }
 
@@ -30,6 +30,7 @@
 struct QuestInfo;
 
 class AIhelper;
+class DangerHeatmap;
 
 class AIStatus
 {
@@ -109,12 +110,14 @@ public:
 
 	AIStatus status;
 	std::string battlename;
+	std::vector<ObjectInstanceID> battleArmies; //armies of ongoing battle, their dangers change with casualties
 
 	std::shared_ptr<CCallback> myCb;
 
 	std::unique_ptr<boost::thread> makingTurn;
 
 	AIhelper * ah;
+	std::unique_ptr<DangerHeatmap> dangerHeatmap;
 
 	VCAI();
 	virtual ~VCAI();
@@ -404,4 +407,11 @@ public:
 	}
 };
 
+//helper RAII to manage global ai/cb ptrs
+struct SetGlobalState
+{
+	SetGlobalState(VCAI * AI);
+	~SetGlobalState();
+};
+
 void makePossibleUpgrades(const CArmedInstance * obj);
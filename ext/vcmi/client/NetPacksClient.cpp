@@ -178,6 +178,7 @@ void SetMovePoints::applyCl(CClient *cl)
 
 void FoWChange::applyCl(CClient *cl)
 {
+	auto changedTiles = tiles.getTiles();
 	for(auto &i : cl->playerint)
 	{
 		if(cl->getPlayerRelations(i.first, player) == PlayerRelations::SAME_PLAYER && waitForDialogs && LOCPLINT == i.second.get())
@@ -187,9 +188,9 @@ void FoWChange::applyCl(CClient *cl)
 		if(cl->getPlayerRelations(i.first, player) != PlayerRelations::ENEMIES)
 		{
 			if(mode)
-				i.second->tileRevealed(tiles);
+				i.second->tileRevealed(changedTiles);
 			else
-				i.second->tileHidden(tiles);
+				i.second->tileHidden(changedTiles);
 		}
 	}
 	cl->invalidatePaths();
@@ -155,9 +155,9 @@ CCreatureAnimation::CCreatureAnimation(const std::string & name_, TSpeedControll
 	forward = std::make_shared<CAnimation>(name_);
 	reverse = std::make_shared<CAnimation>(name_);
 
-	//todo: optimize
-	forward->preload();
-	reverse->preload();
+	//frames are decoded in background, frames of default animation first
+	forward->preloadAsync(CCreatureAnim::HOLDING);
+	reverse->preloadAsync(CCreatureAnim::HOLDING);
 
 	// if necessary, add one frame into vcmi-only group DEAD
 	if(forward->size(CCreatureAnim::DEAD) == 0)
@@ -21,6 +21,7 @@
 #include "../lib/filesystem/ISimpleResourceLoader.h"
 #include "../lib/JsonNode.h"
 #include "../lib/CRandomGenerator.h"
+#include "../lib/CThreadHelper.h"
 
 class SDLImageLoader;
 
@@ -48,7 +49,7 @@ private:
 	//offset[group][frame] - offset of frame data in file
 	std::map<size_t, std::vector <size_t> > offset;
 
-	std::unique_ptr<ui8[]>       data;
+	std::shared_ptr<const ui8>   data; //shared with animation cache
 	std::unique_ptr<SDL_Color[]> palette;
 
 public:
@@ -125,46 +126,38 @@ public:
 };
 
 // Extremely simple file cache. TODO: smarter, more general solution
+/// Keeps recently used files in memory. Files are shared read-only with their users instead of being copied
 class CFileCache
 {
-	static const int cacheSize = 50; //Max number of cached files
-	struct FileData
-	{
-		ResourceID             name;
-		size_t                 size;
-		std::unique_ptr<ui8[]> data;
+	static const size_t cacheSize = 50; //Max number of cached files
 
-		std::unique_ptr<ui8[]> getCopy()
-		{
-			auto ret = std::unique_ptr<ui8[]>(new ui8[size]);
-			std::copy(data.get(), data.get() + size, ret.get());
-			return ret;
-		}
-		FileData(ResourceID name_, size_t size_, std::unique_ptr<ui8[]> data_):
-			name{std::move(name_)},
-			size{size_},
-			data{std::move(data_)}
-		{}
-	};
+	typedef std::pair<ResourceID, std::shared_ptr<const ui8>> TEntry;
 
-	std::deque<FileData> cache;
+	std::list<TEntry> cache; //most recently used files are at the front
+	std::unordered_map<ResourceID, std::list<TEntry>::iterator> index;
 public:
-	std::unique_ptr<ui8[]> getCachedFile(ResourceID rid)
+	std::shared_ptr<const ui8> getCachedFile(ResourceID rid)
 	{
-		for(auto & file : cache)
+		auto it = index.find(rid);
+		if (it != index.end())
 		{
-			if (file.name == rid)
-				return file.getCopy();
+			cache.splice(cache.begin(), cache, it->second);
+			return it->second->second;
 		}
 		// Still here? Cache miss
-		if (cache.size() > cacheSize)
-			cache.pop_front();
+		if (cache.size() >= cacheSize)
+		{
+			index.erase(cache.back().first);
+			cache.pop_back();
+		}
 
-		auto data =  CResourceHandler::get()->load(rid)->readAll();
+		auto data = CResourceHandler::get()->load(rid)->readAll();
+		std::shared_ptr<const ui8> file(data.first.release(), std::default_delete<ui8[]>());
 
-		cache.emplace_back(std::move(rid), data.second, std::move(data.first));
+		cache.emplace_front(rid, file);
+		index[rid] = cache.begin();
 
-		return cache.back().getCopy();
+		return file;
 	}
 };
 
@@ -184,6 +177,74 @@ enum class DefType : uint32_t
 
 static CFileCache animationCache;
 
+/// Frame of def file queued for decoding on background thread
+/// Frame that is requested before any worker has started on it is decoded by requesting thread instead
+class CFrameDecodeTask
+{
+	enum class EState
+	{
+		QUEUED,
+		RUNNING,
+		DONE,
+		CANCELLED
+	};
+
+	std::shared_ptr<CDefFile> defFile;
+	size_t frame;
+	size_t group;
+
+	EState state;
+	std::shared_ptr<IImage> result;
+	boost::mutex mx;
+	boost::condition_variable cond;
+
+	//switches task from QUEUED to RUNNING, returns false if task was taken by someone else or cancelled
+	//both have to be called with locked mutex
+	bool start();
+	void decode(boost::unique_lock<boost::mutex> & lock);
+public:
+	const int priority;
+	ui64 sequence;
+
+	CFrameDecodeTask(std::shared_ptr<CDefFile> DefFile, size_t Frame, size_t Group, int Priority);
+
+	//called by worker threads
+	void run();
+	//returns decoded frame, decoding it in current thread if no worker took this task yet
+	std::shared_ptr<IImage> get();
+	//frame is no longer needed, task will be skipped by workers
+	void cancel();
+};
+
+/// Pool of threads decoding frames, tasks with higher priority are decoded first, equal ones in order of submission
+class CFrameDecoder
+{
+	struct TaskOrder
+	{
+		bool operator()(const std::shared_ptr<CFrameDecodeTask> & lhs, const std::shared_ptr<CFrameDecodeTask> & rhs) const
+		{
+			if(lhs->priority != rhs->priority)
+				return lhs->priority < rhs->priority;
+			return lhs->sequence > rhs->sequence;
+		}
+	};
+
+	std::priority_queue<std::shared_ptr<CFrameDecodeTask>, std::vector<std::shared_ptr<CFrameDecodeTask>>, TaskOrder> tasks;
+	ui64 nextSequence;
+	bool stopping;
+	boost::mutex mx;
+	boost::condition_variable cond;
+	boost::thread_group workers;
+
+	CFrameDecoder();
+	void work();
+public:
+	~CFrameDecoder();
+
+	static CFrameDecoder & get();
+	void push(std::shared_ptr<CFrameDecodeTask> task);
+};
+
 /*************************************************************************
  *  DefFile, class used for def loading                                  *
  *************************************************************************/
@@ -239,9 +300,9 @@ CDefFile::CDefFile(std::string Name):
 
 	for (ui32 i= 0; i<256; i++)
 	{
-		palette[i].r = data[it++];
-		palette[i].g = data[it++];
-		palette[i].b = data[it++];
+		palette[i].r = data.get()[it++];
+		palette[i].g = data.get()[it++];
+		palette[i].b = data.get()[it++];
 		palette[i].a = SDL_ALPHA_OPAQUE;
 	}
 
@@ -766,6 +827,143 @@ SDLImage::~SDLImage()
 	SDL_FreeSurface(surf);
 }
 
+/*************************************************************************
+ *  Background decoding of def frames                                    *
+ *************************************************************************/
+
+CFrameDecodeTask::CFrameDecodeTask(std::shared_ptr<CDefFile> DefFile, size_t Frame, size_t Group, int Priority):
+	defFile(DefFile),
+	frame(Frame),
+	group(Group),
+	state(EState::QUEUED),
+	priority(Priority),
+	sequence(0)
+{
+}
+
+bool CFrameDecodeTask::start()
+{
+	if(state != EState::QUEUED)
+		return false;
+	state = EState::RUNNING;
+	return true;
+}
+
+void CFrameDecodeTask::decode(boost::unique_lock<boost::mutex> & lock)
+{
+	lock.unlock();
+	std::shared_ptr<IImage> image;
+	try
+	{
+		image = std::make_shared<SDLImage>(defFile.get(), frame, group);
+	}
+	catch(...)
+	{
+		//give the frame back, whoever requests it will decode it again and get the error
+		lock.lock();
+		state = EState::QUEUED;
+		cond.notify_all();
+		throw;
+	}
+	lock.lock();
+	result = image;
+	defFile.reset();
+	state = EState::DONE;
+	cond.notify_all();
+}
+
+void CFrameDecodeTask::run()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	if(!start())
+		return;
+	try
+	{
+		decode(lock);
+	}
+	catch(std::exception & e)
+	{
+		logAnim->warn("Failed to decode frame in background: %s", e.what());
+	}
+}
+
+std::shared_ptr<IImage> CFrameDecodeTask::get()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	while(state == EState::RUNNING)
+		cond.wait(lock);
+
+	if(start())
+		decode(lock);
+	return result;
+}
+
+void CFrameDecodeTask::cancel()
+{
+	boost::unique_lock<boost::mutex> lock(mx);
+	if(state == EState::QUEUED)
+	{
+		state = EState::CANCELLED;
+		defFile.reset();
+	}
+}
+
+CFrameDecoder::CFrameDecoder():
+	nextSequence(0),
+	stopping(false)
+{
+	//leave one core for main thread
+	uint32_t threadCount = boost::thread::hardware_concurrency();
+	vstd::amax(threadCount, 2);
+	for(uint32_t i = 0; i < threadCount - 1; i++)
+		workers.create_thread(std::bind(&CFrameDecoder::work, this));
+}
+
+CFrameDecoder::~CFrameDecoder()
+{
+	{
+		boost::unique_lock<boost::mutex> lock(mx);
+		stopping = true;
+	}
+	cond.notify_all();
+	workers.join_all();
+}
+
+CFrameDecoder & CFrameDecoder::get()
+{
+	static CFrameDecoder decoder;
+	return decoder;
+}
+
+void CFrameDecoder::push(std::shared_ptr<CFrameDecodeTask> task)
+{
+	{
+		boost::unique_lock<boost::mutex> lock(mx);
+		task->sequence = nextSequence++;
+		tasks.push(task);
+	}
+	cond.notify_one();
+}
+
+void CFrameDecoder::work()
+{
+	setThreadName("CFrameDecoder::work");
+	while(true)
+	{
+		std::shared_ptr<CFrameDecodeTask> task;
+		{
+			boost::unique_lock<boost::mutex> lock(mx);
+			while(tasks.empty() && !stopping)
+				cond.wait(lock);
+			if(stopping)
+				return;
+			task = tasks.top();
+			tasks.pop();
+		}
+		task->run();
+	}
+}
+
 std::shared_ptr<IImage> CAnimation::getFromExtraDef(std::string filename)
 {
 	size_t pos = filename.find(':');
@@ -834,6 +1032,17 @@ bool CAnimation::loadFrame(size_t frame, size_t group)
 
 bool CAnimation::unloadFrame(size_t frame, size_t group)
 {
+	auto groupIter = pending.find(group);
+	if(groupIter != pending.end() && vstd::contains(groupIter->second, frame))
+	{
+		groupIter->second[frame].task->cancel();
+		groupIter->second.erase(frame);
+
+		if(groupIter->second.empty())
+			pending.erase(groupIter);
+		return true;
+	}
+
 	auto image = getImage(frame, group, false);
 	if(image)
 	{
@@ -846,6 +1055,74 @@ bool CAnimation::unloadFrame(size_t frame, size_t group)
 	return false;
 }
 
+void CAnimation::loadFrameAsync(size_t frame, size_t group, int priority)
+{
+	auto groupIter = pending.find(group);
+	if(groupIter != pending.end() && vstd::contains(groupIter->second, frame))
+		return;
+
+	if(getImage(frame, group, false))
+		return;
+
+	if(defFile && source[group][frame].getType() == JsonNode::JsonType::DATA_NULL)
+	{
+		auto frameList = defFile->getEntries();
+
+		if(vstd::contains(frameList, group) && frameList.at(group) > frame)
+		{
+			auto task = std::make_shared<CFrameDecodeTask>(defFile, frame, group, priority);
+			pending[group][frame].task = task;
+			CFrameDecoder::get().push(task);
+			return;
+		}
+	}
+	//not in def file, load it right away together with all error handling
+	loadFrame(frame, group);
+}
+
+std::shared_ptr<IImage> CAnimation::finishFrame(size_t frame, size_t group) const
+{
+	auto groupIter = pending.find(group);
+	if(groupIter == pending.end())
+		return nullptr;
+
+	auto frameIter = groupIter->second.find(frame);
+	if(frameIter == groupIter->second.end())
+		return nullptr;
+
+	PendingFrame pendingFrame = std::move(frameIter->second);
+	groupIter->second.erase(frameIter);
+	if(groupIter->second.empty())
+		pending.erase(groupIter);
+
+	auto image = pendingFrame.task->get();
+	for(auto & transform : pendingFrame.transforms)
+		transform(*image);
+
+	images[group][frame] = image;
+	return image;
+}
+
+void CAnimation::finishAllFrames() const
+{
+	while(!pending.empty())
+	{
+		const auto & group = *pending.begin();
+		finishFrame(group.second.begin()->first, group.first);
+	}
+}
+
+void CAnimation::transformImages(std::function<void(IImage &)> transform)
+{
+	for(auto & group : images)
+		for(auto & image : group.second)
+			transform(*image.second);
+
+	for(auto & group : pending)
+		for(auto & frame : group.second)
+			frame.second.transforms.push_back(transform);
+}
+
 void CAnimation::initFromJson(const JsonNode & config)
 {
 	std::string basepath;
@@ -887,6 +1164,8 @@ void CAnimation::initFromJson(const JsonNode & config)
 
 void CAnimation::exportBitmaps(const boost::filesystem::path& path) const
 {
+	finishAllFrames();
+
 	if(images.empty())
 	{
 		logGlobal->error("Nothing to export, animation is empty");
@@ -981,7 +1260,12 @@ CAnimation::CAnimation():
 	init();
 }
 
-CAnimation::~CAnimation() = default;
+CAnimation::~CAnimation()
+{
+	for(auto & group : pending)
+		for(auto & frame : group.second)
+			frame.second.task->cancel();
+}
 
 void CAnimation::duplicateImage(const size_t sourceGroup, const size_t sourceFrame, const size_t targetGroup)
 {
@@ -1031,6 +1315,9 @@ std::shared_ptr<IImage> CAnimation::getImage(size_t frame, size_t group, bool ve
 		if (imageIter != groupIter->second.end())
 			return imageIter->second;
 	}
+	auto image = finishFrame(frame, group);
+	if (image)
+		return image;
 	if (verbose)
 		printError(frame, group, "GetImage");
 	return nullptr;
@@ -1060,6 +1347,20 @@ void CAnimation::preload()
 	}
 }
 
+void CAnimation::preloadAsync(size_t visibleGroup)
+{
+	if(!preloaded)
+	{
+		preloaded = true;
+		for(auto & elem : source)
+		{
+			int priority = elem.first == visibleGroup ? 1 : 0;
+			for(size_t image = 0; image < elem.second.size(); image++)
+				loadFrameAsync(image, elem.first, priority);
+		}
+	}
+}
+
 void CAnimation::loadGroup(size_t group)
 {
 	if (vstd::contains(source, group))
@@ -1094,23 +1395,26 @@ size_t CAnimation::size(size_t group) const
 
 void CAnimation::horizontalFlip()
 {
-	for(auto & group : images)
-		for(auto & image : group.second)
-			image.second->horizontalFlip();
+	transformImages([](IImage & image)
+	{
+		image.horizontalFlip();
+	});
 }
 
 void CAnimation::verticalFlip()
 {
-	for(auto & group : images)
-		for(auto & image : group.second)
-			image.second->verticalFlip();
+	transformImages([](IImage & image)
+	{
+		image.verticalFlip();
+	});
 }
 
 void CAnimation::playerColored(PlayerColor player)
 {
-	for(auto & group : images)
-		for(auto & image : group.second)
-			image.second->playerColored(player);
+	transformImages([=](IImage & image)
+	{
+		image.playerColored(player);
+	});
 }
 
 void CAnimation::createFlippedGroup(const size_t sourceGroup, const size_t targetGroup)
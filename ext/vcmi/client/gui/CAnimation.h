@@ -15,6 +15,7 @@
 
 struct SDL_Surface;
 class JsonNode;
+class CFrameDecodeTask;
 class CDefFile;
 
 /*
@@ -63,7 +64,17 @@ private:
 	std::map<size_t, std::vector <JsonNode> > source;
 
 	//bitmap[group][position], store objects with loaded bitmaps
-	std::map<size_t, std::map<size_t, std::shared_ptr<IImage> > > images;
+	mutable std::map<size_t, std::map<size_t, std::shared_ptr<IImage> > > images;
+
+	//frame that is being decoded in background, changes made to the animation meanwhile are applied once it is done
+	struct PendingFrame
+	{
+		std::shared_ptr<CFrameDecodeTask> task;
+		std::vector<std::function<void(IImage &)>> transforms;
+	};
+
+	//pending[group][position], frames queued by preloadAsync() that were not requested yet
+	mutable std::map<size_t, std::map<size_t, PendingFrame> > pending;
 
 	//animation file name
 	std::string name;
@@ -78,6 +89,16 @@ private:
 	//unloadFrame, returns true if image has been unloaded ( either deleted or decreased refCount)
 	bool unloadFrame(size_t frame, size_t group);
 
+	//queues frame from def file for decoding in background, other frames are loaded immediately
+	void loadFrameAsync(size_t frame, size_t group, int priority);
+
+	//moves decoded frame from pending to images, waiting for decoding to finish if necessary
+	std::shared_ptr<IImage> finishFrame(size_t frame, size_t group) const;
+	void finishAllFrames() const;
+
+	//applies change to all loaded images and to all frames still being decoded
+	void transformImages(std::function<void(IImage &)> transform);
+
 	//initialize animation from file
 	void initFromJson(const JsonNode & input);
 	void init();
@@ -109,6 +130,9 @@ public:
 	void load  ();
 	void unload();
 	void preload();
+	//same as preload() but frames are decoded on background threads, frames from visibleGroup first
+	//frames requested before their decoding is done are finished on demand
+	void preloadAsync(size_t visibleGroup = 0);
 
 	//all frames from group
 	void loadGroup  (size_t group);
@@ -35,6 +35,9 @@
 #include "../../lib/CModHandler.h"
 #include "../../lib/filesystem/Filesystem.h"
 #include "../../lib/mapping/CMapInfo.h"
+#include "../../lib/mapping/CMapHeaderCache.h"
+#include "../../lib/CThreadHelper.h"
+#include "../../lib/VCMIDirs.h"
 #include "../../lib/serializer/Connection.h"
 
 
@@ -505,63 +508,106 @@ void SelectionTab::restoreLastSelection()
 	}
 }
 
+void SelectionTab::parseInParallel(std::vector<Task> & tasks)
+{
+	uint32_t threadCount = boost::thread::hardware_concurrency();
+	vstd::amin(threadCount, tasks.size());
+	vstd::amax(threadCount, 1);
+
+	CThreadHelper helper(&tasks, threadCount);
+	helper.run();
+}
+
 void SelectionTab::parseMaps(const std::unordered_set<ResourceID> & files)
 {
 	logGlobal->debug("Parsing %d maps", files.size());
 	allItems.clear();
+
+	CMapHeaderCache headerCache(VCMIDirs::get().userCachePath() / "mapHeaders.dat");
+	headerCache.load();
+
+	std::vector<std::shared_ptr<CMapInfo>> parsed(files.size());
+	std::vector<Task> tasks;
+	size_t index = 0;
 	for(auto & file : files)
 	{
-		try
+		auto & result = parsed[index++];
+		tasks.push_back([&file, &result, &headerCache]()
 		{
-			auto mapInfo = std::make_shared<CMapInfo>();
-			mapInfo->mapInit(file.getName());
+			try
+			{
+				auto mapInfo = std::make_shared<CMapInfo>();
+				mapInfo->mapInit(file.getName(), &headerCache);
+				result = mapInfo;
+			}
+			catch(std::exception & e)
+			{
+				logGlobal->error("Map %s is invalid. Message: %s", file.getName(), e.what());
+			}
+		});
+	}
+	parseInParallel(tasks);
+	headerCache.save();
 
-			// ignore unsupported map versions (e.g. WoG maps without WoG)
-			// but accept VCMI maps
-			if((mapInfo->mapHeader->version >= EMapFormat::VCMI) || (mapInfo->mapHeader->version <= CGI->modh->settings.data["textData"]["mapVersion"].Float()))
-				allItems.push_back(mapInfo);
-		}
-		catch(std::exception & e)
-		{
-			logGlobal->error("Map %s is invalid. Message: %s", file.getName(), e.what());
-		}
+	for(auto & mapInfo : parsed)
+	{
+		// ignore unsupported map versions (e.g. WoG maps without WoG)
+		// but accept VCMI maps
+		if(mapInfo && ((mapInfo->mapHeader->version >= EMapFormat::VCMI) || (mapInfo->mapHeader->version <= CGI->modh->settings.data["textData"]["mapVersion"].Float())))
+			allItems.push_back(mapInfo);
 	}
 }
 
 void SelectionTab::parseSaves(const std::unordered_set<ResourceID> & files)
 {
+	const ui8 loadMode = CSH->getLoadMode();
+
+	std::vector<std::shared_ptr<CMapInfo>> parsed(files.size());
+	std::vector<Task> tasks;
+	size_t index = 0;
 	for(auto & file : files)
 	{
-		try
+		auto & result = parsed[index++];
+		tasks.push_back([&file, &result, loadMode]()
 		{
-			auto mapInfo = std::make_shared<CMapInfo>();
-			mapInfo->saveInit(file);
+			try
+			{
+				auto mapInfo = std::make_shared<CMapInfo>();
+				mapInfo->saveInit(file);
+
+				// Filter out other game modes
+				bool isCampaign = mapInfo->scenarioOptionsOfSave->mode == StartInfo::CAMPAIGN;
+				bool isMultiplayer = mapInfo->amountOfHumanPlayersInSave > 1;
+				switch(loadMode)
+				{
+				case ELoadMode::SINGLE:
+					if(isMultiplayer || isCampaign)
+						mapInfo->mapHeader.reset();
+					break;
+				case ELoadMode::CAMPAIGN:
+					if(!isCampaign)
+						mapInfo->mapHeader.reset();
+					break;
+				default:
+					if(!isMultiplayer)
+						mapInfo->mapHeader.reset();
+					break;
+				}
 
-			// Filter out other game modes
-			bool isCampaign = mapInfo->scenarioOptionsOfSave->mode == StartInfo::CAMPAIGN;
-			bool isMultiplayer = mapInfo->amountOfHumanPlayersInSave > 1;
-			switch(CSH->getLoadMode())
+				result = mapInfo;
+			}
+			catch(const std::exception & e)
 			{
-			case ELoadMode::SINGLE:
-				if(isMultiplayer || isCampaign)
-					mapInfo->mapHeader.reset();
-				break;
-			case ELoadMode::CAMPAIGN:
-				if(!isCampaign)
-					mapInfo->mapHeader.reset();
-				break;
-			default:
-				if(!isMultiplayer)
-					mapInfo->mapHeader.reset();
-				break;
+				logGlobal->error("Error: Failed to process %s: %s", file.getName(), e.what());
 			}
+		});
+	}
+	parseInParallel(tasks);
 
+	for(auto & mapInfo : parsed)
+	{
+		if(mapInfo)
 			allItems.push_back(mapInfo);
-		}
-		catch(const std::exception & e)
-		{
-			logGlobal->error("Error: Failed to process %s: %s", file.getName(), e.what());
-		}
 	}
 }
 
@@ -91,6 +91,8 @@ private:
 	std::shared_ptr<CLabel> labelMapSizes;
 	ESelectionScreen tabType;
 
+	/// map and save headers are independent of each other, so they are read on all cores
+	void parseInParallel(std::vector<std::function<void()>> & tasks);
 	void parseMaps(const std::unordered_set<ResourceID> & files);
 	void parseSaves(const std::unordered_set<ResourceID> & files);
 	void parseCampaigns(const std::unordered_set<ResourceID> & files);
@@ -0,0 +1,225 @@
+/*
+ * CFogOfWarMap.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "CFogOfWarMap.h"
+
+namespace
+{
+	//bits from first to last inclusive
+	ui64 spanMask(int first, int last)
+	{
+		return (~ui64(0) << first) & (~ui64(0) >> (63 - last));
+	}
+}
+
+TileRun::TileRun():
+	length(0)
+{
+}
+
+TileRun::TileRun(const int3 & Start, si32 Length):
+	start(Start),
+	length(Length)
+{
+}
+
+void CTileRuns::add(const int3 & start, si32 length)
+{
+	if(length <= 0)
+		return;
+
+	if(!runs.empty())
+	{
+		TileRun & last = runs.back();
+		if(last.start.y == start.y && last.start.z == start.z && last.start.x + last.length == start.x)
+		{
+			last.length += length;
+			return;
+		}
+	}
+	runs.push_back(TileRun(start, length));
+}
+
+void CTileRuns::add(const int3 & tile)
+{
+	add(tile, 1);
+}
+
+void CTileRuns::clear()
+{
+	runs.clear();
+}
+
+bool CTileRuns::empty() const
+{
+	return runs.empty();
+}
+
+const std::vector<TileRun> & CTileRuns::getRuns() const
+{
+	return runs;
+}
+
+std::unordered_set<int3, ShashInt3> CTileRuns::getTiles() const
+{
+	std::unordered_set<int3, ShashInt3> tiles;
+	for(const TileRun & run : runs)
+		for(int x = 0; x < run.length; x++)
+			tiles.insert(int3(run.start.x + x, run.start.y, run.start.z));
+	return tiles;
+}
+
+CFogOfWarMap::CFogOfWarMap():
+	size(0, 0, 0)
+{
+}
+
+void CFogOfWarMap::resize(const int3 & mapSize)
+{
+	size = mapSize;
+	bits.assign(wordsPerRow() * size.y * size.z, 0);
+}
+
+const int3 & CFogOfWarMap::getSize() const
+{
+	return size;
+}
+
+size_t CFogOfWarMap::wordsPerRow() const
+{
+	return (size.x + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+size_t CFogOfWarMap::rowStart(int y, int z) const
+{
+	return (static_cast<size_t>(z) * size.y + y) * wordsPerRow();
+}
+
+bool CFogOfWarMap::isVisible(const int3 & tile) const
+{
+	assert(tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < size.x && tile.y < size.y && tile.z < size.z);
+	return (bits[rowStart(tile.y, tile.z) + tile.x / BITS_PER_WORD] >> (tile.x % BITS_PER_WORD)) & 1;
+}
+
+void CFogOfWarMap::setVisible(const int3 & tile, bool visible)
+{
+	assert(tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < size.x && tile.y < size.y && tile.z < size.z);
+	setSpan(tile.y, tile.z, tile.x, tile.x, visible);
+}
+
+void CFogOfWarMap::setVisible(const CTileRuns & tiles, bool visible)
+{
+	for(const TileRun & run : tiles.getRuns())
+		setSpan(run.start.y, run.start.z, run.start.x, run.start.x + run.length - 1, visible);
+}
+
+void CFogOfWarMap::revealRange(const int3 & center, int radius, int3::EDistanceFormula formula)
+{
+	forEachRowInRange(size, center, radius, formula, [&](int y, int first, int last)
+	{
+		setSpan(y, center.z, first, last, true);
+	});
+}
+
+void CFogOfWarMap::hideRange(const int3 & center, int radius, int3::EDistanceFormula formula)
+{
+	forEachRowInRange(size, center, radius, formula, [&](int y, int first, int last)
+	{
+		setSpan(y, center.z, first, last, false);
+	});
+}
+
+void CFogOfWarMap::getTilesInRange(CTileRuns & tiles, const int3 & center, int radius, int mode, int3::EDistanceFormula formula) const
+{
+	forEachRowInRange(size, center, radius, formula, [&](int y, int first, int last)
+	{
+		getSpan(tiles, y, center.z, first, last, mode);
+	});
+}
+
+void CFogOfWarMap::getAllTiles(CTileRuns & tiles, int mode) const
+{
+	for(int z = 0; z < size.z; z++)
+		for(int y = 0; y < size.y; y++)
+			getSpan(tiles, y, z, 0, size.x - 1, mode);
+}
+
+void CFogOfWarMap::setSpan(int y, int z, int first, int last, bool visible)
+{
+	assert(first >= 0 && last < size.x && first <= last);
+	size_t row = rowStart(y, z);
+	for(int word = first / BITS_PER_WORD; word <= last / BITS_PER_WORD; word++)
+	{
+		int from = std::max(first - word * BITS_PER_WORD, 0);
+		int to = std::min(last - word * BITS_PER_WORD, BITS_PER_WORD - 1);
+		ui64 mask = spanMask(from, to);
+
+		if(visible)
+			bits[row + word] |= mask;
+		else
+			bits[row + word] &= ~mask;
+	}
+}
+
+void CFogOfWarMap::getSpan(CTileRuns & tiles, int y, int z, int first, int last, int mode) const
+{
+	if(mode == 0)
+		tiles.add(int3(first, y, z), last - first + 1);
+	else
+		getMatchingSpan(tiles, y, z, first, last, mode == -1);
+}
+
+void CFogOfWarMap::getMatchingSpan(CTileRuns & tiles, int y, int z, int first, int last, bool visible) const
+{
+	size_t row = rowStart(y, z);
+	int runStart = -1;
+
+	auto endRun = [&](int end)
+	{
+		if(runStart >= 0)
+		{
+			tiles.add(int3(runStart, y, z), end - runStart);
+			runStart = -1;
+		}
+	};
+
+	for(int word = first / BITS_PER_WORD; word <= last / BITS_PER_WORD; word++)
+	{
+		int base = word * BITS_PER_WORD;
+		int from = std::max(first - base, 0);
+		int to = std::min(last - base, BITS_PER_WORD - 1);
+		ui64 mask = spanMask(from, to);
+		ui64 matching = (visible ? bits[row + word] : ~bits[row + word]) & mask;
+
+		if(matching == mask) //whole span in this word matches
+		{
+			if(runStart < 0)
+				runStart = base + from;
+		}
+		else if(matching == 0)
+		{
+			endRun(base + from);
+		}
+		else
+		{
+			for(int bit = from; bit <= to; bit++)
+			{
+				if((matching >> bit) & 1)
+				{
+					if(runStart < 0)
+						runStart = base + bit;
+				}
+				else
+					endRun(base + bit);
+			}
+		}
+	}
+	endRun(last + 1);
+}
@@ -0,0 +1,127 @@
+/*
+ * CFogOfWarMap.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+#include "int3.h"
+
+/// Horizontal run of tiles: start and following length-1 tiles in the same row
+struct DLL_LINKAGE TileRun
+{
+	int3 start;
+	si32 length;
+
+	TileRun();
+	TileRun(const int3 & Start, si32 Length);
+
+	template <typename Handler> void serialize(Handler & h, const int version)
+	{
+		h & start;
+		h & length;
+	}
+};
+
+/// Tiles stored as horizontal runs, compact description of area revealed or hidden at once.
+/// Areas added one after another may overlap
+class DLL_LINKAGE CTileRuns
+{
+public:
+	/// appends run of tiles, it is joined with the last run if they are adjacent
+	void add(const int3 & start, si32 length);
+	void add(const int3 & tile);
+
+	void clear();
+	bool empty() const;
+	const std::vector<TileRun> & getRuns() const;
+
+	/// every tile once, for interfaces that take tiles one by one
+	std::unordered_set<int3, ShashInt3> getTiles() const;
+
+	template <typename Handler> void serialize(Handler & h, const int version)
+	{
+		h & runs;
+	}
+
+private:
+	std::vector<TileRun> runs;
+};
+
+/// Visibility of map tiles for one team, one bit per tile.
+/// Every row starts at new word, so runs of tiles are revealed, hidden and collected by whole words
+class DLL_LINKAGE CFogOfWarMap
+{
+public:
+	CFogOfWarMap();
+
+	/// mapSize holds width, height and number of levels of the map, all tiles become hidden
+	void resize(const int3 & mapSize);
+	const int3 & getSize() const;
+
+	bool isVisible(const int3 & tile) const;
+	void setVisible(const int3 & tile, bool visible);
+	void setVisible(const CTileRuns & tiles, bool visible);
+
+	/// reveals or hides all tiles within radius from center
+	void revealRange(const int3 & center, int radius, int3::EDistanceFormula formula = int3::DIST_2D);
+	void hideRange(const int3 & center, int radius, int3::EDistanceFormula formula = int3::DIST_2D);
+
+	/// mode 1 - only hidden tiles; mode 0 - all, mode -1 - only visible, same as in CPrivilegedInfoCallback::getTilesInRange
+	void getTilesInRange(CTileRuns & tiles, const int3 & center, int radius, int mode, int3::EDistanceFormula formula = int3::DIST_2D) const;
+	/// same for all tiles of the map
+	void getAllTiles(CTileRuns & tiles, int mode) const;
+
+	/// calls fn(y, firstX, lastX) for every row of tiles within radius from center, clipped to map of given size
+	/// tiles are the ones with center.dist(tile, formula) <= radius
+	template<typename Fn>
+	static void forEachRowInRange(const int3 & mapSize, const int3 & center, int radius, int3::EDistanceFormula formula, Fn fn)
+	{
+		if(radius < 0 || center.z < 0 || center.z >= mapSize.z)
+			return;
+
+		for(int dy = -radius; dy <= radius; dy++)
+		{
+			int y = center.y + dy;
+			if(y < 0 || y >= mapSize.y)
+				continue;
+
+			//all supported distances grow with |dx|, so row is a single span
+			int halfWidth = radius;
+			while(halfWidth >= 0 && center.dist(int3(center.x + halfWidth, y, center.z), formula) > static_cast<ui32>(radius))
+				halfWidth--;
+			if(halfWidth < 0)
+				continue;
+
+			int first = std::max(center.x - halfWidth, 0);
+			int last = std::min(center.x + halfWidth, mapSize.x - 1);
+			if(first <= last)
+				fn(y, first, last);
+		}
+	}
+
+	template <typename Handler> void serialize(Handler & h, const int version)
+	{
+		h & size;
+		h & bits;
+	}
+
+private:
+	static const int BITS_PER_WORD = 64;
+
+	int3 size;
+	std::vector<ui64> bits;
+
+	size_t wordsPerRow() const;
+	size_t rowStart(int y, int z) const;
+
+	void setSpan(int y, int z, int first, int last, bool visible);
+	/// adds runs of tiles in [first, last] which have given visibility
+	void getMatchingSpan(CTileRuns & tiles, int y, int z, int first, int last, bool visible) const;
+	/// adds tiles in [first, last] selected by mode, as in getTilesInRange
+	void getSpan(CTileRuns & tiles, int y, int z, int first, int last, int mode) const;
+};
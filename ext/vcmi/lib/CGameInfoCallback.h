@@ -14,6 +14,7 @@
 #include "battle/CPlayerBattleCallback.h"
 
 class CGObjectInstance;
+class CFogOfWarMap;
 struct InfoWindow;
 struct PlayerSettings;
 struct CPackForClient;
@@ -146,7 +147,7 @@ public:
 
 	virtual int getResourceAmount(Res::ERes type) const;
 	virtual TResources getResourceAmount() const;
-	virtual const std::vector< std::vector< std::vector<ui8> > > & getVisibilityMap()const; //returns visibility map
+	virtual const CFogOfWarMap & getVisibilityMap()const; //returns visibility map
 	//virtual const PlayerSettings * getPlayerSettings(PlayerColor color) const;
 };
 
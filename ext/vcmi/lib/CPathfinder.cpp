@@ -90,9 +90,14 @@ std::vector<int3> CPathfinderHelper::getNeighbourTiles(const PathNodeInfo & sour
 }
 
 NodeStorage::NodeStorage(CPathsInfo & pathsInfo, const CGHeroInstance * hero)
-	:out(pathsInfo)
+	:out(pathsInfo), previousHeroPos(pathsInfo.hpos), graphChanged(false)
 {
+	repairCandidate = out.searchHero == hero;
+	if(!repairCandidate)
+		out.resetNodes();
+
 	out.hero = hero;
+	out.searchHero = hero;
 	out.hpos = hero->getPosition(false);
 }
 
@@ -106,7 +111,14 @@ void NodeStorage::resetTile(
 	EPathfindingLayer layer,
 	CGPathNode::EAccessibility accessibility)
 {
-	getNode(tile, layer)->update(tile, layer, accessibility);
+	size_t index = out.getNodeIndex(tile, layer);
+
+	/// Search tree is kept until we know whether it can be reused
+	/// Tiles hero moved from and to are expected to change
+	if(repairCandidate && out.accessibility[index] != accessibility && tile != previousHeroPos && tile != out.hpos)
+		graphChanged = true;
+
+	out.accessibility[index] = accessibility;
 }
 
 CGPathNode * NodeStorage::getInitialNode()
@@ -128,6 +140,175 @@ void NodeStorage::commit(CDestinationNodeInfo & destination, const PathNodeInfo
 	destination.node->action = destination.action;
 }
 
+std::vector<CGPathNode *> NodeStorage::initializeSearch(const PathfinderConfig * pathfinderConfig, bool allowRepair)
+{
+	std::vector<CGPathNode *> keptNodes;
+
+	bool repaired = false;
+
+	if(repairCandidate)
+	{
+		repaired = allowRepair && isSearchTreeRepairable();
+		if(repaired)
+			keptNodes = repairSearchTree();
+		else
+			resetSearchTree();
+
+		repairCandidate = false;
+	}
+
+	if(repaired)
+		out.repairedSearches++;
+	else
+		out.fullSearches++;
+
+	out.searchTreeVersion = out.hero->getTreeVersion();
+
+	return keptNodes;
+}
+
+bool NodeStorage::isSearchTreeRepairable() const
+{
+	if(graphChanged || out.searchTreeVersion != out.hero->getTreeVersion())
+		return false;
+
+	/// Hero must stand on node of previous tree with exactly same movement points left.
+	/// Since node state only depend on state of previous node every path through it is still optimal.
+	size_t rootIndex = out.getNodeIndex(out.hpos, out.hero->boat ? EPathfindingLayer::SAIL : EPathfindingLayer::LAND);
+	if(!out.isNodeValid(rootIndex))
+		return false;
+
+	const CGPathNode & root = out.nodes.data()[rootIndex];
+	if(root.turns != 0 || root.moveRemains != out.hero->movement || !root.locked)
+		return false;
+
+	switch(root.action)
+	{
+	case CGPathNode::UNKNOWN:
+		return root.theNodeBefore == nullptr; //hero haven't moved
+	case CGPathNode::NORMAL:
+	case CGPathNode::EMBARK:
+	case CGPathNode::DISEMBARK:
+	case CGPathNode::TELEPORT_NORMAL:
+		return true;
+	}
+
+	/// Hero that visited or fought on the way have different movement options on that tile
+	return false;
+}
+
+std::vector<CGPathNode *> NodeStorage::repairSearchTree()
+{
+	enum ENodeState : ui8
+	{
+		UNKNOWN = 0,
+		KEPT,
+		DISCARDED,
+		UNREACHED
+	};
+
+	CGPathNode * nodes = out.nodes.data();
+	const size_t nodesCount = out.nodes.num_elements();
+	const size_t rootIndex = out.getNodeIndex(out.hpos, out.hero->boat ? EPathfindingLayer::SAIL : EPathfindingLayer::LAND);
+	CGPathNode * root = &nodes[rootIndex];
+
+	std::vector<ui8> state(nodesCount, UNKNOWN);
+	std::vector<CGPathNode *> chain;
+
+	/// Nodes on tiles hero moved from and to have changed accessibility so they're always calculated again
+	for(auto tile : {previousHeroPos, out.hpos})
+	{
+		for(EPathfindingLayer layer = EPathfindingLayer::LAND; layer <= EPathfindingLayer::AIR; layer.advance(1))
+			state[out.getNodeIndex(tile, layer)] = DISCARDED;
+	}
+
+	state[rootIndex] = KEPT;
+
+	/// Only subtree of node hero is standing on is kept
+	for(size_t i = 0; i < nodesCount; i++)
+	{
+		if(state[i] != UNKNOWN)
+			continue;
+
+		if(!out.isNodeValid(i) || !nodes[i].reachable())
+		{
+			state[i] = UNREACHED;
+			continue;
+		}
+
+		ui8 chainState = DISCARDED;
+		chain.clear();
+		for(CGPathNode * node = &nodes[i]; node; node = node->theNodeBefore)
+		{
+			if(state[node - nodes] != UNKNOWN)
+			{
+				chainState = state[node - nodes] == KEPT ? KEPT : DISCARDED;
+				break;
+			}
+
+			chain.push_back(node);
+		}
+
+		for(auto node : chain)
+			state[node - nodes] = chainState;
+	}
+
+	auto hasDiscardedNeighbour = [&](const CGPathNode & node) -> bool
+	{
+		for(int dx = -1; dx <= 1; dx++)
+		{
+			for(int dy = -1; dy <= 1; dy++)
+			{
+				int3 tile(node.coord.x + dx, node.coord.y + dy, node.coord.z);
+				if(!vstd::iswithin(tile.x, 0, out.sizes.x - 1) || !vstd::iswithin(tile.y, 0, out.sizes.y - 1))
+					continue;
+
+				for(EPathfindingLayer layer = EPathfindingLayer::LAND; layer <= EPathfindingLayer::AIR; layer.advance(1))
+				{
+					if(state[out.getNodeIndex(tile, layer)] == DISCARDED)
+						return true;
+				}
+			}
+		}
+
+		return false;
+	};
+
+	/// Kept nodes are final, but explored ones that border discarded part of graph have to be explored again.
+	/// Nodes with special actions may lead to teleport exits so they're always explored.
+	std::vector<CGPathNode *> keptNodes;
+	for(size_t i = 0; i < nodesCount; i++)
+	{
+		CGPathNode & node = nodes[i];
+
+		if(state[i] == DISCARDED)
+		{
+			out.invalidateNode(i);
+		}
+		else if(state[i] == KEPT && node.locked && &node != root)
+		{
+			/// Kept nodes that weren't explored by previous search are final too, there is no way further from them
+			if(node.action != CGPathNode::NORMAL || hasDiscardedNeighbour(node))
+			{
+				node.locked = false;
+				keptNodes.push_back(&node);
+			}
+		}
+	}
+
+	root->theNodeBefore = nullptr;
+	root->action = CGPathNode::UNKNOWN;
+	root->accessible = out.accessibility[rootIndex];
+	root->locked = false;
+
+	return keptNodes;
+}
+
+void NodeStorage::resetSearchTree()
+{
+	out.resetNodes();
+}
+
 PathfinderOptions::PathfinderOptions()
 {
 	useFlying = settings["pathfinder"]["layers"]["flying"].Bool();
@@ -143,6 +324,115 @@ PathfinderOptions::PathfinderOptions()
 	lightweightFlyingMode = settings["pathfinder"]["lightweightFlyingMode"].Bool();
 	oneTurnSpecialLayersLimit = settings["pathfinder"]["oneTurnSpecialLayersLimit"].Bool();
 	originalMovementRules = settings["pathfinder"]["originalMovementRules"].Bool();
+	incrementalRepair = settings["pathfinder"]["incrementalRepair"].Bool();
+	useBucketQueue = settings["pathfinder"]["bucketQueue"].Bool();
+}
+
+void NodeHeap::push(CGPathNode * node)
+{
+	heap.push(node);
+}
+
+CGPathNode * NodeHeap::pop()
+{
+	auto node = heap.top();
+
+	heap.pop();
+
+	return node;
+}
+
+bool NodeHeap::empty() const
+{
+	return heap.empty();
+}
+
+NodeBucketQueue::NodeBucketQueue()
+	: lastKey(0), entriesCount(0)
+{
+}
+
+ui64 NodeBucketQueue::getKey(const CGPathNode * node)
+{
+	return (static_cast<ui64>(node->turns) << 32) | (std::numeric_limits<ui32>::max() - node->moveRemains);
+}
+
+int NodeBucketQueue::getBucket(ui64 key) const
+{
+	/// Bucket is defined by highest bit that differs from last popped key
+	ui64 diff = key ^ lastKey;
+	int bucket = 0;
+
+	for(int shift = 32; shift > 0; shift /= 2)
+	{
+		if(diff >> shift)
+		{
+			diff >>= shift;
+			bucket += shift;
+		}
+	}
+
+	return diff ? bucket + 1 : 0;
+}
+
+void NodeBucketQueue::push(CGPathNode * node)
+{
+	ui64 key = getKey(node);
+
+	/// Embarking with free boarding may give more movement points than hero had before.
+	/// Radix order is restored by lowering last key and redistributing queued entries.
+	if(key < lastKey)
+		rebucket(key);
+
+	buckets[getBucket(key)].push_back(std::make_pair(key, node));
+	entriesCount++;
+}
+
+void NodeBucketQueue::rebucket(ui64 key)
+{
+	std::vector<TEntry> entries;
+	entries.reserve(entriesCount);
+
+	for(auto & bucket : buckets)
+	{
+		vstd::concatenate(entries, bucket);
+		bucket.clear();
+	}
+
+	lastKey = key;
+	for(auto & entry : entries)
+		buckets[getBucket(entry.first)].push_back(entry);
+}
+
+CGPathNode * NodeBucketQueue::pop()
+{
+	assert(entriesCount);
+
+	if(buckets[0].empty())
+	{
+		int bucket = 1;
+		while(buckets[bucket].empty())
+			bucket++;
+
+		std::vector<TEntry> entries;
+		entries.swap(buckets[bucket]);
+
+		lastKey = boost::min_element(entries)->first;
+		for(auto & entry : entries)
+			buckets[getBucket(entry.first)].push_back(entry);
+	}
+
+	auto node = buckets[0].back().second;
+
+	buckets[0].pop_back();
+	entriesCount--;
+
+	return node;
+}
+
+bool NodeBucketQueue::empty() const
+{
+	return entriesCount == 0;
 }
 
 void MovementCostRule::process(
@@ -225,6 +515,11 @@ CPathfinder::CPathfinder(
 
 	hlp = make_unique<CPathfinderHelper>(_gs, hero, config->options);
 
+	if(config->options.useBucketQueue)
+		pq = make_unique<NodeBucketQueue>();
+	else
+		pq = make_unique<NodeHeap>();
+
 	initializePatrol();
 	initializeGraph();
 }
@@ -233,6 +528,13 @@ void CPathfinder::calculatePaths()
 {
 	//logGlobal->info("Calculating paths for hero %s (adress  %d) of player %d", hero->name, hero , hero->tempOwner);
 
+	/// Tree of previous search can't be reused if hero movement depends on its initial position
+	bool allowRepair = config->options.incrementalRepair
+		&& patrolState == PATROL_NONE
+		&& !(config->options.useFlying && config->options.lightweightFlyingMode);
+
+	auto keptNodes = config->nodeStorage->initializeSearch(config.get(), allowRepair);
+
 	//initial tile - set cost on 0 and add to the queue
 	CGPathNode * initialNode = config->nodeStorage->getInitialNode();
 
@@ -245,14 +547,21 @@ void CPathfinder::calculatePaths()
 	if(isHeroPatrolLocked())
 		return;
 
-	pq.push(initialNode);
-	while(!pq.empty())
+	pq->push(initialNode);
+	for(CGPathNode * node : keptNodes)
+		pq->push(node);
+
+	while(!pq->empty())
 	{
-		auto node = pq.top();
+		auto node = pq->pop();
+
+		/// Node pushed again after its path was improved is explored only once
+		if(node->locked)
+			continue;
+
 		auto excludeOurHero = node->coord == initialNode->coord;
 
 		source.setNode(gs, node, excludeOurHero);
-		pq.pop();
 		source.node->locked = true;
 
 		int movement = source.node->moveRemains, turn = source.node->turns;
@@ -305,7 +614,7 @@ void CPathfinder::calculatePaths()
 			}
 
 			if(!destination.blocked)
-				pq.push(destination.node);
+				pq->push(destination.node);
 			
 		} //neighbours loop
 
@@ -339,7 +648,7 @@ void CPathfinder::calculatePaths()
 				config->nodeStorage->commit(destination, source);
 
 				if(destination.node->action == CGPathNode::TELEPORT_NORMAL)
-					pq.push(destination.node);
+					pq->push(destination.node);
 			}
 		}
 	} //queue loop
@@ -886,7 +1195,7 @@ void CPathfinder::initializeGraph()
 
 CGPathNode::EAccessibility CPathfinder::evaluateAccessibility(const int3 & pos, const TerrainTile * tinfo, const ELayer layer) const
 {
-	if(tinfo->terType == ETerrainType::ROCK || !FoW[pos.x][pos.y][pos.z])
+	if(tinfo->terType == ETerrainType::ROCK || !FoW.isVisible(pos))
 		return CGPathNode::BLOCKED;
 
 	switch(layer)
@@ -1358,10 +1667,12 @@ void CGPath::convert(ui8 mode)
 }
 
 CPathsInfo::CPathsInfo(const int3 & Sizes)
-	: sizes(Sizes)
+	: sizes(Sizes), generation(1), searchHero(nullptr), searchTreeVersion(0), repairedSearches(0), fullSearches(0)
 {
 	hero = nullptr;
 	nodes.resize(boost::extents[sizes.x][sizes.y][sizes.z][ELayer::NUM_LAYERS]);
+	nodeGenerations.resize(nodes.num_elements(), 0);
+	accessibility.resize(nodes.num_elements(), CGPathNode::NOT_SET);
 }
 
 CPathsInfo::~CPathsInfo()
@@ -1409,16 +1720,59 @@ int CPathsInfo::getDistance(const int3 & tile) const
 
 const CGPathNode * CPathsInfo::getNode(const int3 & coord) const
 {
-	auto landNode = &nodes[coord.x][coord.y][coord.z][ELayer::LAND];
+	auto landNode = refreshNode(getNodeIndex(coord, ELayer::LAND), coord, ELayer::LAND);
 	if(landNode->reachable())
 		return landNode;
 	else
-		return &nodes[coord.x][coord.y][coord.z][ELayer::SAIL];
+		return refreshNode(getNodeIndex(coord, ELayer::SAIL), coord, ELayer::SAIL);
 }
 
 CGPathNode * CPathsInfo::getNode(const int3 & coord, const ELayer layer)
 {
-	return &nodes[coord.x][coord.y][coord.z][layer];
+	return refreshNode(getNodeIndex(coord, layer), coord, layer);
+}
+
+size_t CPathsInfo::getNodeIndex(const int3 & coord, const ELayer layer) const
+{
+	return ((coord.x * sizes.y + coord.y) * sizes.z + coord.z) * ELayer::NUM_LAYERS + layer;
+}
+
+bool CPathsInfo::isNodeValid(size_t index) const
+{
+	return nodeGenerations[index] == generation;
+}
+
+void CPathsInfo::invalidateNode(size_t index)
+{
+	nodeGenerations[index] = 0;
+}
+
+void CPathsInfo::resetNodes()
+{
+	generation++;
+
+	/// Zero is never valid generation, on overflow all nodes are invalidated explicitly
+	if(!generation)
+	{
+		boost::fill(nodeGenerations, 0);
+		generation = 1;
+	}
+}
+
+CGPathNode * CPathsInfo::refreshNode(size_t index, const int3 & coord, const ELayer layer) const
+{
+	CGPathNode * node = nodes.data() + index;
+
+	if(nodeGenerations[index] != generation)
+	{
+		node->coord = coord;
+		node->layer = layer;
+		node->reset();
+		node->accessible = accessibility[index];
+		nodeGenerations[index] = generation;
+	}
+
+	return node;
 }
 
 PathNodeInfo::PathNodeInfo()
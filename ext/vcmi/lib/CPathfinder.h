@@ -21,6 +21,7 @@ class CGObjectInstance;
 struct TerrainTile;
 class CPathfinderHelper;
 class CMap;
+class CFogOfWarMap;
 class CGWhirlpool;
 class CPathfinderHelper;
 class CPathfinder;
@@ -87,16 +88,40 @@ struct DLL_LINKAGE CPathsInfo
 	const CGHeroInstance * hero;
 	int3 hpos;
 	int3 sizes;
-	boost::multi_array<CGPathNode, 4> nodes; //[w][h][level][layer]
+
+	/// Nodes are reset lazily on first access, node is only up to date if its generation is the current one.
+	/// Accessibility is kept in dense array so new search doesn't have to touch every node.
+	/// Const accessors refresh nodes in place, so they do it only while holding pathMx.
+	mutable boost::multi_array<CGPathNode, 4> nodes; //[w][h][level][layer]
+	mutable std::vector<ui32> nodeGenerations;
+	std::vector<CGPathNode::EAccessibility> accessibility;
+	ui32 generation;
+
+	/// Hero for which nodes were calculated by last search. Unlike hero it's not reset when paths are invalidated
+	/// so search tree can be repaired after hero movement instead of being calculated from scratch
+	const CGHeroInstance * searchHero;
+	int64_t searchTreeVersion; //bonus tree version used by last search
+
+	/// Number of searches that repaired previous search tree and that started from scratch
+	ui32 repairedSearches;
+	ui32 fullSearches;
 
 	CPathsInfo(const int3 & Sizes);
 	~CPathsInfo();
 	const CGPathNode * getPathInfo(const int3 & tile) const;
 	bool getPath(CGPath & out, const int3 & dst) const;
 	int getDistance(const int3 & tile) const;
-	const CGPathNode * getNode(const int3 & coord) const;
 
 	CGPathNode * getNode(const int3 & coord, const ELayer layer);
+
+	size_t getNodeIndex(const int3 & coord, const ELayer layer) const;
+	bool isNodeValid(size_t index) const;
+	void invalidateNode(size_t index);
+	void resetNodes(); //all nodes are reset without touching them
+
+private:
+	const CGPathNode * getNode(const int3 & coord) const; //caller must hold pathMx
+	CGPathNode * refreshNode(size_t index, const int3 & coord, const ELayer layer) const;
 };
 
 struct DLL_LINKAGE PathNodeInfo
@@ -248,12 +273,26 @@ public:
 		const CPathfinderHelper * pathfinderHelper) = 0;
 
 	virtual void commit(CDestinationNodeInfo & destination, const PathNodeInfo & source) = 0;
+
+	/// Called once graph is initialized. Storage may keep nodes settled by previous search if they're still valid.
+	/// Returns kept nodes which neighbours have to be explored again, empty if search starts from scratch.
+	virtual std::vector<CGPathNode *> initializeSearch(const PathfinderConfig * pathfinderConfig, bool allowRepair)
+	{
+		return std::vector<CGPathNode *>();
+	}
 };
 
 class DLL_LINKAGE NodeStorage : public INodeStorage
 {
 private:
 	CPathsInfo & out;
+	int3 previousHeroPos;
+	bool repairCandidate; //search tree from previous search is kept until we know whether it can be reused
+	bool graphChanged;
+
+	bool isSearchTreeRepairable() const;
+	std::vector<CGPathNode *> repairSearchTree();
+	void resetSearchTree();
 
 public:
 	NodeStorage(CPathsInfo & pathsInfo, const CGHeroInstance * hero);
@@ -277,6 +316,70 @@ public:
 		CGPathNode::EAccessibility accessibility) override;
 
 	virtual void commit(CDestinationNodeInfo & destination, const PathNodeInfo & source) override;
+
+	virtual std::vector<CGPathNode *> initializeSearch(const PathfinderConfig * pathfinderConfig, bool allowRepair) override;
+};
+
+/// Queue of nodes to explore. Node with least turns and most movement points left goes first.
+/// Node can be pushed several times, every time its path is improved.
+class INodeQueue
+{
+public:
+	virtual ~INodeQueue() {}
+
+	virtual void push(CGPathNode * node) = 0;
+	virtual CGPathNode * pop() = 0;
+	virtual bool empty() const = 0;
+};
+
+class DLL_LINKAGE NodeHeap : public INodeQueue
+{
+private:
+	struct NodeComparer
+	{
+		bool operator()(const CGPathNode * lhs, const CGPathNode * rhs) const
+		{
+			if(rhs->turns > lhs->turns)
+				return false;
+			else if(rhs->turns == lhs->turns && rhs->moveRemains <= lhs->moveRemains)
+				return false;
+
+			return true;
+		}
+	};
+	boost::heap::priority_queue<CGPathNode *, boost::heap::compare<NodeComparer> > heap;
+
+public:
+	virtual void push(CGPathNode * node) override;
+	virtual CGPathNode * pop() override;
+	virtual bool empty() const override;
+};
+
+/// Radix heap keyed on turns and movement points spent within turn.
+/// Push and pop are amortized O(1) since each node only move to lower buckets.
+/// Pushed node is normally never better than last popped one since movement points are only spent.
+/// Free ship boarding is an exception, such push redistribute whole queue in O(n).
+class DLL_LINKAGE NodeBucketQueue : public INodeQueue
+{
+private:
+	typedef std::pair<ui64, CGPathNode *> TEntry;
+
+	static const int NUM_BUCKETS = 65;
+
+	std::array<std::vector<TEntry>, NUM_BUCKETS> buckets;
+	ui64 lastKey;
+	size_t entriesCount;
+
+	static ui64 getKey(const CGPathNode * node);
+	int getBucket(ui64 key) const;
+	void rebucket(ui64 key);
+
+public:
+	NodeBucketQueue();
+
+	virtual void push(CGPathNode * node) override;
+	virtual CGPathNode * pop() override;
+	virtual bool empty() const override;
 };
 
 struct DLL_LINKAGE PathfinderOptions
@@ -327,6 +430,17 @@ struct DLL_LINKAGE PathfinderOptions
 	///   I find it's reasonable limitation, but it's will make some movements more expensive than in H3.
 	bool originalMovementRules;
 
+	/// If enabled search tree of previous calculation is reused after hero step.
+	/// Only part of tree that isn't reachable via new hero position is calculated again.
+	/// Full search is still done when anything else on map changed since previous calculation.
+	/// Disabled by default until its gain over full search is measured.
+	bool incrementalRepair;
+
+	/// Use bucket queue instead of binary heap for nodes to explore.
+	/// Path costs are the same, but nodes of equal cost are explored in different order than from heap
+	/// so another of equally good paths may be chosen. Disabled by default to keep paths of existing games.
+	bool useBucketQueue;
+
 	PathfinderOptions();
 };
 
@@ -359,7 +473,7 @@ private:
 	typedef EPathfindingLayer ELayer;
 	
 	const CGHeroInstance * hero;
-	const std::vector<std::vector<std::vector<ui8> > > &FoW;
+	const CFogOfWarMap &FoW;
 	std::unique_ptr<CPathfinderHelper> hlp;
 	std::shared_ptr<PathfinderConfig> config;
 
@@ -370,19 +484,7 @@ private:
 	} patrolState;
 	std::unordered_set<int3, ShashInt3> patrolTiles;
 
-	struct NodeComparer
-	{
-		bool operator()(const CGPathNode * lhs, const CGPathNode * rhs) const
-		{
-			if(rhs->turns > lhs->turns)
-				return false;
-			else if(rhs->turns == lhs->turns && rhs->moveRemains <= lhs->moveRemains)
-				return false;
-
-			return true;
-		}
-	};
-	boost::heap::priority_queue<CGPathNode *, boost::heap::compare<NodeComparer> > pq;
+	std::unique_ptr<INodeQueue> pq;
 
 	PathNodeInfo source; //current (source) path node -> we took it from the queue
 	CDestinationNodeInfo destination; //destination node -> it's a neighbour of source that we consider
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "HeroBonus.h"
+#include "CFogOfWarMap.h"
 
 class CGHeroInstance;
 class CGTownInstance;
@@ -72,8 +73,7 @@ struct DLL_LINKAGE TeamState : public CBonusSystemNode
 public:
 	TeamID id; //position in gameState::teams
 	std::set<PlayerColor> players; // members of this team
-	//TODO: boost::array, bool if possible
-	std::vector<std::vector<std::vector<ui8> > >  fogOfWarMap; //true - visible, false - hidden
+	CFogOfWarMap fogOfWarMap;
 
 	TeamState();
 	TeamState(TeamState && other);
@@ -82,7 +82,25 @@ public:
 	{
 		h & id;
 		h & players;
-		h & fogOfWarMap;
+		if(version >= 791)
+		{
+			h & fogOfWarMap;
+		}
+		else
+		{
+			//save format backward compatibility, map used to be stored as [x][y][z] bytes
+			std::vector<std::vector<std::vector<ui8> > > legacyFogOfWar;
+			h & legacyFogOfWar;
+			if(!h.saving)
+			{
+				int levels = legacyFogOfWar.empty() || legacyFogOfWar[0].empty() ? 0 : legacyFogOfWar[0][0].size();
+				fogOfWarMap.resize(int3(legacyFogOfWar.size(), levels ? legacyFogOfWar[0].size() : 0, levels));
+				for(int x = 0; x < fogOfWarMap.getSize().x; x++)
+					for(int y = 0; y < fogOfWarMap.getSize().y; y++)
+						for(int z = 0; z < fogOfWarMap.getSize().z; z++)
+							fogOfWarMap.setVisible(int3(x, y, z), legacyFogOfWar[x][y][z]);
+			}
+		}
 		h & static_cast<CBonusSystemNode&>(*this);
 	}
 
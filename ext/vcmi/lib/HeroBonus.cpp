@@ -213,9 +213,10 @@ JsonNode CAddInfo::toJsonNode() const
 }
 
 std::atomic<int32_t> CBonusSystemNode::treeChanged(1);
+std::atomic<int32_t> CBonusSystemNode::nodeChangeCounter(0);
 const bool CBonusSystemNode::cachingEnabled = true;
 
-BonusList::BonusList(bool BelongsToTree) : belongsToTree(BelongsToTree)
+BonusList::BonusList()
 {
 
 }
@@ -224,13 +225,10 @@ BonusList::BonusList(const BonusList &bonusList)
 {
 	bonuses.resize(bonusList.size());
 	std::copy(bonusList.begin(), bonusList.end(), bonuses.begin());
-	belongsToTree = false;
 }
 
-BonusList::BonusList(BonusList&& other):
-	belongsToTree(false)
+BonusList::BonusList(BonusList&& other)
 {
-	std::swap(belongsToTree, other.belongsToTree);
 	std::swap(bonuses, other.bonuses);
 }
 
@@ -238,16 +236,9 @@ BonusList& BonusList::operator=(const BonusList &bonusList)
 {
 	bonuses.resize(bonusList.size());
 	std::copy(bonusList.begin(), bonusList.end(), bonuses.begin());
-	belongsToTree = false;
 	return *this;
 }
 
-void BonusList::changed()
-{
-    if(belongsToTree)
-		CBonusSystemNode::treeHasChanged();
-}
-
 void BonusList::stackBonuses()
 {
 	boost::sort(bonuses, [](std::shared_ptr<Bonus> b1, std::shared_ptr<Bonus> b2) -> bool
@@ -287,59 +278,67 @@ void BonusList::stackBonuses()
 	}
 }
 
-int BonusList::totalValue() const
+BonusValueAccumulator::BonusValueAccumulator()
+	: base(0),
+	percentToBase(0),
+	percentToAll(0),
+	additive(0),
+	indepMax(0),
+	hasIndepMax(false),
+	indepMin(0),
+	hasIndepMin(false),
+	notIndepBonuses(0)
 {
-	int base = 0;
-	int percentToBase = 0;
-	int percentToAll = 0;
-	int additive = 0;
-	int indepMax = 0;
-	bool hasIndepMax = false;
-	int indepMin = 0;
-	bool hasIndepMin = false;
+}
 
-	for(std::shared_ptr<Bonus> b : bonuses)
+void BonusValueAccumulator::add(const Bonus * b)
+{
+	switch(b->valType)
 	{
-		switch(b->valType)
+	case Bonus::BASE_NUMBER:
+		base += b->val;
+		break;
+	case Bonus::PERCENT_TO_ALL:
+		percentToAll += b->val;
+		break;
+	case Bonus::PERCENT_TO_BASE:
+		percentToBase += b->val;
+		break;
+	case Bonus::ADDITIVE_VALUE:
+		additive += b->val;
+		break;
+	case Bonus::INDEPENDENT_MAX:
+		if (!hasIndepMax)
 		{
-		case Bonus::BASE_NUMBER:
-			base += b->val;
-			break;
-		case Bonus::PERCENT_TO_ALL:
-			percentToAll += b->val;
-			break;
-		case Bonus::PERCENT_TO_BASE:
-			percentToBase += b->val;
-			break;
-		case Bonus::ADDITIVE_VALUE:
-			additive += b->val;
-			break;
-		case Bonus::INDEPENDENT_MAX:
-			if (!hasIndepMax)
-			{
-				indepMax = b->val;
-				hasIndepMax = true;
-			}
-			else
-			{
-				vstd::amax(indepMax, b->val);
-			}
-
-			break;
-		case Bonus::INDEPENDENT_MIN:
-			if (!hasIndepMin)
-			{
-				indepMin = b->val;
-				hasIndepMin = true;
-			}
-			else
-			{
-				vstd::amin(indepMin, b->val);
-			}
+			indepMax = b->val;
+			hasIndepMax = true;
+		}
+		else
+		{
+			vstd::amax(indepMax, b->val);
+		}
 
-			break;
+		break;
+	case Bonus::INDEPENDENT_MIN:
+		if (!hasIndepMin)
+		{
+			indepMin = b->val;
+			hasIndepMin = true;
+		}
+		else
+		{
+			vstd::amin(indepMin, b->val);
 		}
+
+		break;
 	}
+
+	if(b->valType != Bonus::INDEPENDENT_MAX && b->valType != Bonus::INDEPENDENT_MIN)
+		notIndepBonuses++;
+}
+
+int BonusValueAccumulator::total() const
+{
 	int modifiedBase = base + (base * percentToBase) / 100;
 	modifiedBase += additive;
 	int valFirst = (modifiedBase * (100 + percentToAll)) / 100;
@@ -347,11 +346,6 @@ int BonusList::totalValue() const
 	if(hasIndepMin && hasIndepMax)
 		assert(indepMin < indepMax);
 
-	const int notIndepBonuses = boost::count_if(bonuses, [](const std::shared_ptr<Bonus>& b)
-	{
-		return b->valType != Bonus::INDEPENDENT_MAX && b->valType != Bonus::INDEPENDENT_MIN;
-	});
-
 	if (hasIndepMax)
 	{
 		if(notIndepBonuses)
@@ -370,6 +364,16 @@ int BonusList::totalValue() const
 	return valFirst;
 }
 
+int BonusList::totalValue() const
+{
+	BonusValueAccumulator accumulator;
+
+	for(auto & b : bonuses)
+		accumulator.add(b.get());
+
+	return accumulator.total();
+}
+
 std::shared_ptr<Bonus> BonusList::getFirst(const CSelector &select)
 {
 	for (auto & b : bonuses)
@@ -413,10 +417,16 @@ void BonusList::getAllBonuses(BonusList &out) const
 
 int BonusList::valOfBonuses(const CSelector &select) const
 {
-	BonusList ret;
-	CSelector limit = nullptr;
-	getBonuses(ret, select, limit);
-	return ret.totalValue();
+	BonusValueAccumulator accumulator;
+
+	//same bonuses as getBonuses with empty limit would return
+	for(auto & b : bonuses)
+	{
+		if(b->effectRange == Bonus::NO_LIMIT && select(b.get()))
+			accumulator.add(b.get());
+	}
+
+	return accumulator.total();
 }
 
 JsonNode BonusList::toJsonNode() const
@@ -430,19 +440,16 @@ JsonNode BonusList::toJsonNode() const
 void BonusList::push_back(std::shared_ptr<Bonus> x)
 {
 	bonuses.push_back(x);
-	changed();
 }
 
 BonusList::TInternalContainer::iterator BonusList::erase(const int position)
 {
-	changed();
 	return bonuses.erase(bonuses.begin() + position);
 }
 
 void BonusList::clear()
 {
 	bonuses.clear();
-	changed();
 }
 
 std::vector<BonusList*>::size_type BonusList::operator-=(std::shared_ptr<Bonus> const &i)
@@ -451,20 +458,17 @@ std::vector<BonusList*>::size_type BonusList::operator-=(std::shared_ptr<Bonus>
 	if(itr == bonuses.end())
 		return false;
 	bonuses.erase(itr);
-	changed();
 	return true;
 }
 
 void BonusList::resize(BonusList::TInternalContainer::size_type sz, std::shared_ptr<Bonus> c )
 {
 	bonuses.resize(sz, c);
-	changed();
 }
 
 void BonusList::insert(BonusList::TInternalContainer::iterator position, BonusList::TInternalContainer::size_type n, std::shared_ptr<Bonus> const &x)
 {
 	bonuses.insert(position, n, x);
-	changed();
 }
 
 int IBonusBearer::valOfBonuses(Bonus::BonusType type, const CSelector &selector) const
@@ -474,24 +478,27 @@ int IBonusBearer::valOfBonuses(Bonus::BonusType type, const CSelector &selector)
 
 int IBonusBearer::valOfBonuses(Bonus::BonusType type, int subtype) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << type << "s_" << subtype;
-
 	CSelector s = Selector::type(type);
 	if(subtype != -1)
 		s = s.And(Selector::subtype(subtype));
 
-	return valOfBonuses(s, cachingStr.str());
+	return aggregateBonusValue(s);
 }
 
 int IBonusBearer::valOfBonuses(const CSelector &selector, const std::string &cachingStr) const
 {
+	if(cachingStr.empty())
+		return aggregateBonusValue(selector);
+
 	CSelector limit = nullptr;
 	TBonusListPtr hlp = getAllBonuses(selector, limit, nullptr, cachingStr);
 	return hlp->totalValue();
 }
 bool IBonusBearer::hasBonus(const CSelector &selector, const std::string &cachingStr) const
 {
+	if(cachingStr.empty())
+		return hasMatchingBonus(selector);
+
 	return getBonuses(selector, cachingStr)->size() > 0;
 }
 
@@ -502,14 +509,11 @@ bool IBonusBearer::hasBonus(const CSelector &selector, const CSelector &limit, c
 
 bool IBonusBearer::hasBonusOfType(Bonus::BonusType type, int subtype) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "type_" << type << "s_" << subtype;
-
 	CSelector s = Selector::type(type);
 	if(subtype != -1)
 		s = s.And(Selector::subtype(subtype));
 
-	return hasBonus(s, cachingStr.str());
+	return hasMatchingBonus(s);
 }
 
 const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const std::string &cachingStr) const
@@ -524,9 +528,17 @@ const TBonusListPtr IBonusBearer::getBonuses(const CSelector &selector, const CS
 
 bool IBonusBearer::hasBonusFrom(Bonus::BonusSource source, ui32 sourceID) const
 {
-	std::stringstream cachingStr;
-	cachingStr << "source_" << source << "id_" << sourceID;
-	return hasBonus(Selector::source(source,sourceID), cachingStr.str());
+	return hasMatchingBonus(Selector::source(source,sourceID));
+}
+
+int IBonusBearer::aggregateBonusValue(const CSelector &selector) const
+{
+	return getAllBonuses(selector, nullptr)->totalValue();
+}
+
+bool IBonusBearer::hasMatchingBonus(const CSelector &selector) const
+{
+	return !getAllBonuses(selector, nullptr)->empty();
 }
 
 int IBonusBearer::MoraleVal() const
@@ -717,24 +729,10 @@ const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, c
 	bool limitOnUs = (!root || root == this); //caching won't work when we want to limit bonuses against an external node
 	if (CBonusSystemNode::cachingEnabled && limitOnUs)
 	{
-		// Exclusive access for one thread
-		static boost::mutex m;
-		boost::mutex::scoped_lock lock(m);
-
-		// If the bonus system tree changes(state of a single node or the relations to each other) then
-		// cache all bonus objects. Selector objects doesn't matter.
-		if (cachedLast != treeChanged)
-		{
-			cachedBonuses.clear();
-			cachedRequests.clear();
+		// Exclusive access to cache of this node, parent nodes are only read
+		boost::mutex::scoped_lock lock(cacheLock);
 
-			BonusList allBonuses;
-			getAllBonusesRec(allBonuses);
-			limitBonuses(allBonuses, cachedBonuses);
-			cachedBonuses.stackBonuses();
-
-			cachedLast = treeChanged;
-		}
+		updateCachedBonuses();
 
 		// If a bonus system request comes with a caching string then look up in the map if there are any
 		// pre-calculated bonus results. Limiters can't be cached so they have to be calculated.
@@ -765,6 +763,56 @@ const TBonusListPtr CBonusSystemNode::getAllBonuses(const CSelector &selector, c
 	}
 }
 
+int CBonusSystemNode::aggregateBonusValue(const CSelector &selector) const
+{
+	if(!CBonusSystemNode::cachingEnabled)
+		return IBonusBearer::aggregateBonusValue(selector);
+
+	boost::mutex::scoped_lock lock(cacheLock);
+
+	updateCachedBonuses();
+
+	return cachedBonuses.valOfBonuses(selector);
+}
+
+bool CBonusSystemNode::hasMatchingBonus(const CSelector &selector) const
+{
+	if(!CBonusSystemNode::cachingEnabled)
+		return IBonusBearer::hasMatchingBonus(selector);
+
+	boost::mutex::scoped_lock lock(cacheLock);
+
+	updateCachedBonuses();
+
+	for(auto & b : cachedBonuses)
+	{
+		if(b->effectRange == Bonus::NO_LIMIT && selector(b.get()))
+			return true;
+	}
+
+	return false;
+}
+
+void CBonusSystemNode::updateCachedBonuses() const
+{
+	// If this node or any of its ancestors changed (state of a single node or the relations to each other)
+	// then cache all bonus objects. Selector objects doesn't matter.
+	int64_t treeVersion = CBonusSystemNode::getTreeVersion();
+
+	if (cachedLast != treeVersion)
+	{
+		cachedBonuses.clear();
+		cachedRequests.clear();
+
+		BonusList allBonuses;
+		getAllBonusesRec(allBonuses);
+		limitBonuses(allBonuses, cachedBonuses);
+		cachedBonuses.stackBonuses();
+
+		cachedLast = treeVersion;
+	}
+}
+
 const TBonusListPtr CBonusSystemNode::getAllBonusesWithoutCaching(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root) const
 {
 	auto ret = std::make_shared<BonusList>();
@@ -807,18 +855,16 @@ const std::shared_ptr<Bonus> CBonusSystemNode::update(const std::shared_ptr<Bonu
 }
 
 CBonusSystemNode::CBonusSystemNode()
-	: bonuses(true),
-	exportedBonuses(true),
-	nodeType(UNKNOWN),
-	cachedLast(0)
+	: nodeType(UNKNOWN),
+	cachedLast(0),
+	nodeChanged(0)
 {
 }
 
 CBonusSystemNode::CBonusSystemNode(ENodeTypes NodeType)
-	: bonuses(true),
-	exportedBonuses(true),
-	nodeType(NodeType),
-	cachedLast(0)
+	: nodeType(NodeType),
+	cachedLast(0),
+	nodeChanged(0)
 {
 }
 
@@ -827,7 +873,8 @@ CBonusSystemNode::CBonusSystemNode(CBonusSystemNode && other):
 	exportedBonuses(std::move(other.exportedBonuses)),
 	nodeType(other.nodeType),
 	description(other.description),
-	cachedLast(0)
+	cachedLast(0),
+	nodeChanged(0)
 {
 	std::swap(parents, other.parents);
 	std::swap(children, other.children);
@@ -874,7 +921,7 @@ void CBonusSystemNode::attachTo(CBonusSystemNode *parent)
 		newRedDescendant(parent);
 
 	parent->newChildAttached(this);
-	CBonusSystemNode::treeHasChanged();
+	nodeHasChanged();
 }
 
 void CBonusSystemNode::detachFrom(CBonusSystemNode *parent)
@@ -888,7 +935,7 @@ void CBonusSystemNode::detachFrom(CBonusSystemNode *parent)
 
 	parents -= parent;
 	parent->childDetached(this);
-	CBonusSystemNode::treeHasChanged();
+	nodeHasChanged();
 }
 
 void CBonusSystemNode::removeBonusesRecursive(const CSelector & s)
@@ -902,13 +949,21 @@ void CBonusSystemNode::reduceBonusDurations(const CSelector &s)
 {
 	BonusList bl;
 	exportedBonuses.getBonuses(bl, s, Selector::all);
+	bool propagatedChanged = false;
 	for(auto b : bl)
 	{
 		b->turnsRemain--;
 		if(b->turnsRemain <= 0)
 			removeBonus(b);
+		else if(b->propagator)
+			propagatedChanged = true;
 	}
 
+	if(propagatedChanged)
+		CBonusSystemNode::treeHasChanged(); //bonus may be held by many nodes
+	else if(!bl.empty())
+		nodeHasChanged();
+
 	for(CBonusSystemNode *child : children)
 		child->reduceBonusDurations(s);
 }
@@ -924,14 +979,20 @@ void CBonusSystemNode::addNewBonus(const std::shared_ptr<Bonus>& b)
 	assert(!vstd::contains(exportedBonuses, b));
 	exportedBonuses.push_back(b);
 	exportBonus(b);
-	CBonusSystemNode::treeHasChanged();
 }
 
 void CBonusSystemNode::accumulateBonus(const std::shared_ptr<Bonus>& b)
 {
 	auto bonus = exportedBonuses.getFirst(Selector::typeSubtype(b->type, b->subtype)); //only local bonuses are interesting //TODO: what about value type?
 	if(bonus)
+	{
 		bonus->val += b->val;
+
+		if(bonus->propagator)
+			CBonusSystemNode::treeHasChanged(); //bonus may be held by many nodes
+		else
+			nodeHasChanged();
+	}
 	else
 		addNewBonus(std::make_shared<Bonus>(*b)); //duplicate needed, original may get destroyed
 }
@@ -940,10 +1001,14 @@ void CBonusSystemNode::removeBonus(const std::shared_ptr<Bonus>& b)
 {
 	exportedBonuses -= b;
 	if(b->propagator)
+	{
 		unpropagateBonus(b);
+	}
 	else
+	{
 		bonuses -= b;
-	CBonusSystemNode::treeHasChanged();
+		nodeHasChanged();
+	}
 }
 
 void CBonusSystemNode::removeBonuses(const CSelector & selector)
@@ -972,6 +1037,7 @@ void CBonusSystemNode::propagateBonus(std::shared_ptr<Bonus> b)
 	if(b->propagator->shouldBeAttached(this))
 	{
 		bonuses.push_back(b);
+		nodeHasChanged();
 		logBonus->trace("#$# %s #propagated to# %s",  b->Description(), nodeName());
 	}
 
@@ -984,6 +1050,7 @@ void CBonusSystemNode::unpropagateBonus(std::shared_ptr<Bonus> b)
 	if(b->propagator->shouldBeAttached(this))
 	{
 		bonuses -= b;
+		nodeHasChanged();
 		logBonus->trace("#$# %s #is no longer propagated to# %s",  b->Description(), nodeName());
 	}
 
@@ -1108,11 +1175,14 @@ void CBonusSystemNode::getRedDescendants(TNodes &out)
 void CBonusSystemNode::exportBonus(std::shared_ptr<Bonus> b)
 {
 	if(b->propagator)
+	{
 		propagateBonus(b);
+	}
 	else
+	{
 		bonuses.push_back(b);
-
-	CBonusSystemNode::treeHasChanged();
+		nodeHasChanged();
+	}
 }
 
 void CBonusSystemNode::exportBonuses()
@@ -1203,6 +1273,27 @@ TBonusListPtr CBonusSystemNode::limitBonuses(const BonusList &allBonuses) const
 	return ret;
 }
 
+void CBonusSystemNode::nodeHasChanged()
+{
+	stampChange(allocateChangeStamp());
+}
+
+int32_t CBonusSystemNode::allocateChangeStamp()
+{
+	return ++nodeChangeCounter;
+}
+
+void CBonusSystemNode::stampChange(int32_t stamp)
+{
+	if(nodeChanged == stamp)
+		return; //already reached through another parent
+
+	nodeChanged = stamp;
+
+	for(CBonusSystemNode * child : children)
+		child->stampChange(stamp);
+}
+
 void CBonusSystemNode::treeHasChanged()
 {
 	treeChanged++;
@@ -1211,7 +1302,7 @@ void CBonusSystemNode::treeHasChanged()
 int64_t CBonusSystemNode::getTreeVersion() const
 {
 	int64_t ret = treeChanged;
-	return ret << 32;
+	return (ret << 32) + static_cast<uint32_t>(nodeChanged);
 }
 
 int NBonus::valOf(const CBonusSystemNode *obj, Bonus::BonusType type, int subtype)
@@ -1457,8 +1548,8 @@ namespace Selector
 		return CSelectFieldEqual<Bonus::ValueType>(&Bonus::valType)(valType);
 	}
 
-	DLL_LINKAGE CSelector all([](const Bonus * b){return true;});
-	DLL_LINKAGE CSelector none([](const Bonus * b){return false;});
+	DLL_LINKAGE CSelector all = CSelector(BonusFilter());
+	DLL_LINKAGE CSelector none = CSelector(BonusFilter::nothing());
 
 	bool DLL_LINKAGE matchesType(const CSelector &sel, Bonus::BonusType type)
 	{
@@ -29,23 +29,107 @@ typedef std::set<CBonusSystemNode*> TNodes;
 typedef std::set<const CBonusSystemNode*> TCNodes;
 typedef std::vector<CBonusSystemNode *> TNodesVector;
 
+/// Conjunction of equality tests against plain fields of Bonus.
+/// Selector described by filter is matched directly, without calls through std::function.
+struct BonusFilter
+{
+	enum EField
+	{
+		TYPE = 1,
+		SUBTYPE = 2,
+		SOURCE = 4,
+		SOURCE_ID = 8,
+		VALUE_TYPE = 16,
+		EFFECT_RANGE = 32,
+		NEVER = 128 //tests contradict each other, nothing is matched
+	};
+
+	ui8 fields; //tests to be performed
+	si32 type;
+	si32 subtype;
+	si32 source;
+	ui32 sid;
+	si32 valType;
+	si32 effectRange;
+
+	BonusFilter()
+		: fields(0), type(0), subtype(0), source(0), sid(0), valType(0), effectRange(0)
+	{}
+
+	//returns false if given field can't be tested by filter
+	template<typename T>
+	bool setField(T Bonus::*ptr, const T & value)
+	{
+		return false;
+	}
+
+	static BonusFilter nothing()
+	{
+		BonusFilter ret;
+		ret.fields = NEVER;
+		return ret;
+	}
+
+	BonusFilter merge(const BonusFilter & other) const
+	{
+		BonusFilter ret = *this;
+		ret.fields |= other.fields & NEVER;
+		ret.mergeField(other, TYPE, &BonusFilter::type);
+		ret.mergeField(other, SUBTYPE, &BonusFilter::subtype);
+		ret.mergeField(other, SOURCE, &BonusFilter::source);
+		ret.mergeField(other, SOURCE_ID, &BonusFilter::sid);
+		ret.mergeField(other, VALUE_TYPE, &BonusFilter::valType);
+		ret.mergeField(other, EFFECT_RANGE, &BonusFilter::effectRange);
+		return ret;
+	}
+
+	bool matches(const Bonus * b) const;
+
+private:
+	template<typename T>
+	void mergeField(const BonusFilter & other, EField field, T BonusFilter::*value)
+	{
+		if(!(other.fields & field))
+			return;
+
+		if((fields & field) && this->*value != other.*value)
+			fields |= NEVER;
+
+		fields |= field;
+		this->*value = other.*value;
+	}
+};
+
 class CSelector : std::function<bool(const Bonus*)>
 {
 	typedef std::function<bool(const Bonus*)> TBase;
+
+	BonusFilter filter;
+	bool compiled; //selector is fully described by filter
 public:
-	CSelector() {}
+	CSelector()
+		: compiled(false)
+	{}
 	template<typename T>
 	CSelector(const T &t,	//SFINAE trick -> include this c-tor in overload resolution only if parameter is class
 							//(includes functors, lambdas) or function. Without that VC is going mad about ambiguities.
 		typename std::enable_if < boost::mpl::or_ < std::is_class<T>, std::is_function<T >> ::value>::type *dummy = nullptr)
-		: TBase(t)
+		: TBase(t), compiled(false)
+	{}
+
+	CSelector(const BonusFilter & Filter)
+		: filter(Filter), compiled(true)
 	{}
 
 	CSelector(std::nullptr_t)
+		: compiled(false)
 	{}
 
 	CSelector And(CSelector rhs) const
 	{
+		if(compiled && rhs.compiled)
+			return filter.merge(rhs.filter);
+
 		//lambda may likely outlive "this" (it can be even a temporary) => we copy the OBJECT (not pointer)
 		auto thisCopy = *this;
 		return [thisCopy, rhs](const Bonus *b) mutable { return thisCopy(b) && rhs(b); };
@@ -56,14 +140,11 @@ public:
 		return [thisCopy, rhs](const Bonus *b) mutable { return thisCopy(b) || rhs(b); };
 	}
 
-	bool operator()(const Bonus *b) const
-	{
-		return TBase::operator()(b);
-	}
+	bool operator()(const Bonus *b) const;
 
 	operator bool() const
 	{
-		return !!static_cast<const TBase&>(*this);
+		return compiled || !!static_cast<const TBase&>(*this);
 	}
 };
 
@@ -468,6 +549,99 @@ struct DLL_LINKAGE Bonus : public std::enable_shared_from_this<Bonus>
 
 DLL_LINKAGE std::ostream & operator<<(std::ostream &out, const Bonus &bonus);
 
+inline bool BonusFilter::matches(const Bonus * b) const
+{
+	return !(fields & NEVER)
+		&& (!(fields & TYPE) || b->type == type)
+		&& (!(fields & SUBTYPE) || b->subtype == subtype)
+		&& (!(fields & SOURCE) || b->source == source)
+		&& (!(fields & SOURCE_ID) || b->sid == sid)
+		&& (!(fields & VALUE_TYPE) || b->valType == valType)
+		&& (!(fields & EFFECT_RANGE) || b->effectRange == effectRange);
+}
+
+template<>
+inline bool BonusFilter::setField<Bonus::BonusType>(Bonus::BonusType Bonus::*ptr, const Bonus::BonusType & value)
+{
+	fields |= TYPE;
+	type = value;
+	return true;
+}
+
+template<>
+inline bool BonusFilter::setField<TBonusSubtype>(TBonusSubtype Bonus::*ptr, const TBonusSubtype & value)
+{
+	if(ptr != &Bonus::subtype)
+		return false;
+
+	fields |= SUBTYPE;
+	subtype = value;
+	return true;
+}
+
+template<>
+inline bool BonusFilter::setField<Bonus::BonusSource>(Bonus::BonusSource Bonus::*ptr, const Bonus::BonusSource & value)
+{
+	fields |= SOURCE;
+	source = value;
+	return true;
+}
+
+template<>
+inline bool BonusFilter::setField<ui32>(ui32 Bonus::*ptr, const ui32 & value)
+{
+	if(ptr != &Bonus::sid)
+		return false;
+
+	fields |= SOURCE_ID;
+	sid = value;
+	return true;
+}
+
+template<>
+inline bool BonusFilter::setField<Bonus::ValueType>(Bonus::ValueType Bonus::*ptr, const Bonus::ValueType & value)
+{
+	fields |= VALUE_TYPE;
+	valType = value;
+	return true;
+}
+
+template<>
+inline bool BonusFilter::setField<Bonus::LimitEffect>(Bonus::LimitEffect Bonus::*ptr, const Bonus::LimitEffect & value)
+{
+	fields |= EFFECT_RANGE;
+	effectRange = value;
+	return true;
+}
+
+inline bool CSelector::operator()(const Bonus *b) const
+{
+	if(compiled)
+		return filter.matches(b);
+
+	return TBase::operator()(b);
+}
+
+/// Sums up values of bonuses one by one, gives same result as BonusList::totalValue
+class DLL_LINKAGE BonusValueAccumulator
+{
+	int base;
+	int percentToBase;
+	int percentToAll;
+	int additive;
+	int indepMax;
+	bool hasIndepMax;
+	int indepMin;
+	bool hasIndepMin;
+	int notIndepBonuses;
+
+public:
+	BonusValueAccumulator();
+
+	void add(const Bonus * b);
+	int total() const;
+};
+
 
 class DLL_LINKAGE BonusList
 {
@@ -476,8 +650,6 @@ public:
 
 private:
 	TInternalContainer bonuses;
-	bool belongsToTree;
-	void changed();
 
 public:
 	typedef TInternalContainer::const_reference const_reference;
@@ -486,7 +658,7 @@ public:
 	typedef TInternalContainer::const_iterator const_iterator;
 	typedef TInternalContainer::iterator iterator;
 
-	BonusList(bool BelongsToTree = false);
+	BonusList();
 	BonusList(const BonusList &bonusList);
 	BonusList(BonusList && other);
 	BonusList& operator=(const BonusList &bonusList);
@@ -652,6 +824,10 @@ public:
 
 	const std::shared_ptr<Bonus> getBonus(const CSelector &selector) const; //returns any bonus visible on node that matches (or nullptr if none matches)
 
+	//queries over not limited bonuses that don't build intermediate bonus list when bearer supports it
+	virtual int aggregateBonusValue(const CSelector &selector) const;
+	virtual bool hasMatchingBonus(const CSelector &selector) const;
+
 	//legacy interface
 	int valOfBonuses(Bonus::BonusType type, const CSelector &selector) const;
 	int valOfBonuses(Bonus::BonusType type, int subtype = -1) const; //subtype -> subtype of bonus, if -1 then anyt;
@@ -700,7 +876,10 @@ private:
 	static const bool cachingEnabled;
 	mutable BonusList cachedBonuses;
 	mutable int64_t cachedLast;
+	mutable boost::mutex cacheLock;
+	int32_t nodeChanged; //stamp of the last change of this node or any of its ancestors
 	static std::atomic<int32_t> treeChanged;
+	static std::atomic<int32_t> nodeChangeCounter;
 
 	// Setting a value to cachingStr before getting any bonuses caches the result for later requests.
 	// This string needs to be unique, that's why it has to be setted in the following manner:
@@ -710,7 +889,9 @@ private:
 	void getBonusesRec(BonusList &out, const CSelector &selector, const CSelector &limit) const;
 	void getAllBonusesRec(BonusList &out) const;
 	const TBonusListPtr getAllBonusesWithoutCaching(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr) const;
+	void updateCachedBonuses() const; //cacheLock must be held
 	const std::shared_ptr<Bonus> update(const std::shared_ptr<Bonus> b) const;
+	void stampChange(int32_t stamp);
 
 public:
 	explicit CBonusSystemNode();
@@ -721,6 +902,8 @@ public:
 	void limitBonuses(const BonusList &allBonuses, BonusList &out) const; //out will bo populed with bonuses that are not limited here
 	TBonusListPtr limitBonuses(const BonusList &allBonuses) const; //same as above, returns out by val for convienence
 	const TBonusListPtr getAllBonuses(const CSelector &selector, const CSelector &limit, const CBonusSystemNode *root = nullptr, const std::string &cachingStr = "") const override;
+	int aggregateBonusValue(const CSelector &selector) const override;
+	bool hasMatchingBonus(const CSelector &selector) const override;
 	void getParents(TCNodes &out) const;  //retrieves list of parent nodes (nodes to inherit bonuses from),
 	const std::shared_ptr<Bonus> getBonusLocalFirst(const CSelector &selector) const;
 
@@ -768,7 +951,12 @@ public:
 	const std::string &getDescription() const;
 	void setDescription(const std::string &description);
 
+	///invalidates bonus caches of this node and all its descendants
+	void nodeHasChanged();
+	///invalidates bonus caches of all nodes, for changes that can't be attributed to a single node
 	static void treeHasChanged();
+	///returns stamp never used by any node, for bonus bearers that keep their own version outside of the tree
+	static int32_t allocateChangeStamp();
 
 	int64_t getTreeVersion() const override;
 
@@ -805,6 +993,10 @@ public:
 
 	CSelector operator()(const T &valueToCompareAgainst) const
 	{
+		BonusFilter filter;
+		if(filter.setField(ptr, valueToCompareAgainst))
+			return filter;
+
 		auto ptr2 = ptr; //We need a COPY because we don't want to reference this (might be outlived by lambda)
 		return [ptr2, valueToCompareAgainst](const Bonus *bonus) {  return bonus->*ptr2 == valueToCompareAgainst; };
 	}
@@ -1093,12 +1285,10 @@ extern DLL_LINKAGE const std::map<std::string, TLimiterPtr> bonusLimiterMap;
 extern DLL_LINKAGE const std::map<std::string, TPropagatorPtr> bonusPropagatorMap;
 extern DLL_LINKAGE const std::map<std::string, TUpdaterPtr> bonusUpdaterMap;
 
-// BonusList template that requires full interface of CBonusSystemNode
 template <class InputIterator>
 void BonusList::insert(const int position, InputIterator first, InputIterator last)
 {
 	bonuses.insert(bonuses.begin() + position, first, last);
-	changed();
 }
 
 // observers for updating bonuses based on certain events (e.g. hero gaining level)
@@ -56,6 +56,22 @@ void CPrivilegedInfoCallback::getFreeTiles(std::vector<int3> & tiles) const
 }
 
 void CPrivilegedInfoCallback::getTilesInRange(std::unordered_set<int3, ShashInt3> & tiles, int3 pos, int radious, boost::optional<PlayerColor> player, int mode, int3::EDistanceFormula distanceFormula) const
+{
+	CTileRuns runs;
+	getTilesInRange(runs, pos, radious, player, mode, distanceFormula);
+	auto found = runs.getTiles();
+	tiles.insert(found.begin(), found.end());
+}
+
+void CPrivilegedInfoCallback::getAllTiles(std::unordered_set<int3, ShashInt3> & tiles, boost::optional<PlayerColor> Player, int level, int surface) const
+{
+	CTileRuns runs;
+	getAllTiles(runs, Player, level, surface);
+	auto found = runs.getTiles();
+	tiles.insert(found.begin(), found.end());
+}
+
+void CPrivilegedInfoCallback::getTilesInRange(CTileRuns & tiles, int3 pos, int radious, boost::optional<PlayerColor> player, int mode, int3::EDistanceFormula distanceFormula) const
 {
 	if(!!player && *player >= PlayerColor::PLAYER_LIMIT)
 	{
@@ -64,30 +80,19 @@ void CPrivilegedInfoCallback::getTilesInRange(std::unordered_set<int3, ShashInt3
 	}
 	if (radious == -1) //reveal entire map
 		getAllTiles (tiles, player, -1, 0);
-	else
+	else if(!player)
 	{
-		const TeamState * team = !player ? nullptr : gs->getPlayerTeam(*player);
-		for (int xd = std::max<int>(pos.x - radious , 0); xd <= std::min<int>(pos.x + radious, gs->map->width - 1); xd++)
+		int3 mapSize(gs->map->width, gs->map->height, gs->map->twoLevel ? 2 : 1);
+		CFogOfWarMap::forEachRowInRange(mapSize, pos, radious, distanceFormula, [&](int y, int first, int last)
 		{
-			for (int yd = std::max<int>(pos.y - radious, 0); yd <= std::min<int>(pos.y + radious, gs->map->height - 1); yd++)
-			{
-				int3 tilePos(xd,yd,pos.z);
-				double distance = pos.dist(tilePos, distanceFormula);
-
-				if(distance <= radious)
-				{
-					if(!player
-						|| (mode == 1  && team->fogOfWarMap[xd][yd][pos.z]==0)
-						|| (mode == -1 && team->fogOfWarMap[xd][yd][pos.z]==1)
-					)
-						tiles.insert(int3(xd,yd,pos.z));
-				}
-			}
-		}
+			tiles.add(int3(first, y, pos.z), last - first + 1);
+		});
 	}
+	else
+		gs->getPlayerTeam(*player)->fogOfWarMap.getTilesInRange(tiles, pos, radious, mode, distanceFormula);
 }
 
-void CPrivilegedInfoCallback::getAllTiles(std::unordered_set<int3, ShashInt3> & tiles, boost::optional<PlayerColor> Player, int level, int surface) const
+void CPrivilegedInfoCallback::getAllTiles(CTileRuns & tiles, boost::optional<PlayerColor> Player, int level, int surface) const
 {
 	if(!!Player && *Player >= PlayerColor::PLAYER_LIMIT)
 	{
@@ -110,14 +115,13 @@ void CPrivilegedInfoCallback::getAllTiles(std::unordered_set<int3, ShashInt3> &
 
 	for (auto zd : floors)
 	{
-
-		for (int xd = 0; xd < gs->map->width; xd++)
+		for (int yd = 0; yd < gs->map->height; yd++)
 		{
-			for (int yd = 0; yd < gs->map->height; yd++)
+			for (int xd = 0; xd < gs->map->width; xd++)
 			{
 				if ((getTile (int3 (xd,yd,zd))->terType == ETerrainType::WATER && water)
 					|| (getTile (int3 (xd,yd,zd))->terType != ETerrainType::WATER && land))
-					tiles.insert(int3(xd,yd,zd));
+					tiles.add(int3(xd,yd,zd));
 			}
 		}
 	}
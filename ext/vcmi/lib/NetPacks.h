@@ -15,6 +15,7 @@
 #include "mapObjects/CGHeroInstance.h"
 #include "ConstTransitivePtr.h"
 #include "int3.h"
+#include "CFogOfWarMap.h"
 #include "ResourceSet.h"
 #include "CGameStateFwd.h"
 #include "mapping/CMapDefines.h"
@@ -302,7 +303,7 @@ struct FoWChange : public CPackForClient
 	void applyCl(CClient *cl);
 	DLL_LINKAGE void applyGs(CGameState *gs);
 
-	std::unordered_set<int3, struct ShashInt3 > tiles;
+	CTileRuns tiles;
 	PlayerColor player;
 	ui8 mode; //mode==0 - hide, mode==1 - reveal
 	bool waitForDialogs;
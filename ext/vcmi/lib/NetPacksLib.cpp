@@ -177,11 +177,10 @@ DLL_LINKAGE void SetMovePoints::applyGs(CGameState *gs)
 DLL_LINKAGE void FoWChange::applyGs(CGameState *gs)
 {
 	TeamState * team = gs->getPlayerTeam(player);
-	for(int3 t : tiles)
-		team->fogOfWarMap[t.x][t.y][t.z] = mode;
+	team->fogOfWarMap.setVisible(tiles, mode);
 	if (mode == 0) //do not hide too much
 	{
-		std::unordered_set<int3, ShashInt3> tilesRevealed;
+		CTileRuns tilesRevealed;
 		for (auto & elem : gs->map->objects)
 		{
 			const CGObjectInstance *o = elem;
@@ -199,8 +198,7 @@ DLL_LINKAGE void FoWChange::applyGs(CGameState *gs)
 				}
 			}
 		}
-		for(int3 t : tilesRevealed) //probably not the most optimal solution ever
-			team->fogOfWarMap[t.x][t.y][t.z] = 1;
+		team->fogOfWarMap.setVisible(tilesRevealed, true);
 	}
 }
 
@@ -550,7 +548,7 @@ void TryMoveHero::applyGs(CGameState *gs)
 	}
 
 	for(int3 t : fowRevealed)
-		gs->getPlayerTeam(h->getOwner())->fogOfWarMap[t.x][t.y][t.z] = 1;
+		gs->getPlayerTeam(h->getOwner())->fogOfWarMap.setVisible(t, true);
 }
 
 DLL_LINKAGE void NewStructures::applyGs(CGameState *gs)
@@ -1298,7 +1296,10 @@ DLL_LINKAGE void BattleTriggerEffect::applyGs(CGameState *gs)
 		auto b = st->getBonusLocalFirst(Selector::source(Bonus::SPELL_EFFECT, SpellID::POISON)
 				.And(Selector::type(Bonus::STACK_HEALTH)));
 		if (b)
+		{
 			b->val = val;
+			st->nodeHasChanged();
+		}
 		break;
 	}
 	case Bonus::ENCHANTER:
@@ -992,6 +992,16 @@ const TBonusListPtr CUnitStateDetached::getAllBonuses(const CSelector & selector
 	return bonus->getAllBonuses(selector, limit, root, cachingStr);
 }
 
+int CUnitStateDetached::aggregateBonusValue(const CSelector & selector) const
+{
+	return bonus->aggregateBonusValue(selector);
+}
+
+bool CUnitStateDetached::hasMatchingBonus(const CSelector & selector) const
+{
+	return bonus->hasMatchingBonus(selector);
+}
+
 int64_t CUnitStateDetached::getTreeVersion() const
 {
 	return bonus->getTreeVersion();
@@ -310,6 +310,8 @@ public:
 
 	const TBonusListPtr getAllBonuses(const CSelector & selector, const CSelector & limit,
 		const CBonusSystemNode * root = nullptr, const std::string & cachingStr = "") const override;
+	int aggregateBonusValue(const CSelector & selector) const override;
+	bool hasMatchingBonus(const CSelector & selector) const override;
 
 	int64_t getTreeVersion() const override;
 
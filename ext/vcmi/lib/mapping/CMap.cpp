@@ -123,6 +123,95 @@ CCastleEvent::CCastleEvent() : town(nullptr)
 
 }
 
+CTileObjectList::CTileObjectList():
+	storage(nullptr)
+{
+}
+
+CTileObjectList::CTileObjectList(const CTileObjectList & other):
+	storage(nullptr)
+{
+	*this = other;
+}
+
+CTileObjectList::CTileObjectList(CTileObjectList && other):
+	storage(other.storage)
+{
+	other.storage = nullptr;
+}
+
+CTileObjectList::~CTileObjectList()
+{
+	release();
+}
+
+CTileObjectList & CTileObjectList::operator=(const CTileObjectList & other)
+{
+	if(this != &other)
+	{
+		clear();
+		reserve(other.size());
+		std::copy(other.begin(), other.end(), objects());
+		if(storage)
+			storage->count = other.size();
+	}
+	return *this;
+}
+
+CTileObjectList & CTileObjectList::operator=(CTileObjectList && other)
+{
+	std::swap(storage, other.storage);
+	return *this;
+}
+
+void CTileObjectList::push_back(CGObjectInstance * object)
+{
+	assert(object);
+	if(!storage || storage->count == storage->capacity)
+		reserve(std::max<size_t>(2, size() * 2));
+
+	objects()[storage->count++] = object;
+}
+
+CTileObjectList::iterator CTileObjectList::erase(iterator pos)
+{
+	size_t index = pos - begin();
+	assert(index < size());
+
+	std::copy(pos + 1, end(), pos);
+	storage->count--;
+
+	if(!storage->count)
+		release(); //keep empty tiles free of allocations
+
+	return begin() + index;
+}
+
+void CTileObjectList::clear()
+{
+	release();
+}
+
+void CTileObjectList::reserve(size_t capacity)
+{
+	if(!capacity || (storage && storage->capacity >= capacity))
+		return;
+
+	auto newStorage = static_cast<Storage *>(::operator new(sizeof(Storage) + capacity * sizeof(CGObjectInstance *)));
+	newStorage->count = size();
+	newStorage->capacity = capacity;
+	std::copy(begin(), end(), reinterpret_cast<CGObjectInstance **>(newStorage + 1));
+
+	release();
+	storage = newStorage;
+}
+
+void CTileObjectList::release()
+{
+	::operator delete(storage);
+	storage = nullptr;
+}
+
 TerrainTile::TerrainTile() : terType(ETerrainType::BORDER), terView(0), riverType(ERiverType::NO_RIVER),
 	riverDir(0), roadType(ERoadType::NO_ROAD), roadDir(0), extTileFlags(0), visitable(false),
 	blocked(false)
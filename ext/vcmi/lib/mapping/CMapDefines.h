@@ -62,6 +62,83 @@ public:
 	}
 };
 
+/// Objects residing in a tile. List is a single pointer to block holding object count and capacity followed by objects.
+/// Most tiles have no objects and allocate nothing, block grows geometrically once objects are added.
+/// Interface and serialized form are the same as of std::vector
+class DLL_LINKAGE CTileObjectList
+{
+public:
+	typedef CGObjectInstance * value_type;
+	typedef size_t size_type;
+	typedef CGObjectInstance ** iterator;
+	typedef CGObjectInstance * const * const_iterator;
+
+	CTileObjectList();
+	CTileObjectList(const CTileObjectList & other);
+	CTileObjectList(CTileObjectList && other);
+	~CTileObjectList();
+
+	CTileObjectList & operator=(const CTileObjectList & other);
+	CTileObjectList & operator=(CTileObjectList && other);
+
+	iterator begin() { return objects(); }
+	iterator end() { return objects() + size(); }
+	const_iterator begin() const { return objects(); }
+	const_iterator end() const { return objects() + size(); }
+
+	size_t size() const { return storage ? storage->count : 0; }
+	bool empty() const { return size() == 0; }
+
+	CGObjectInstance * front() const { return objects()[0]; }
+	CGObjectInstance * back() const { return objects()[size() - 1]; }
+	CGObjectInstance * operator[](size_t index) const { return objects()[index]; }
+
+	void push_back(CGObjectInstance * object);
+	iterator erase(iterator pos);
+	void clear();
+
+	template <typename Handler>
+	void serialize(Handler & h, const int version)
+	{
+		if(h.saving)
+		{
+			ui32 length = size();
+			h & length;
+			for(CGObjectInstance * object : *this)
+				h & object;
+		}
+		else
+		{
+			//read as vector so stored length is checked the same way
+			std::vector<CGObjectInstance *> loaded;
+			h & loaded;
+
+			clear();
+			reserve(loaded.size() - boost::count(loaded, nullptr));
+			for(CGObjectInstance * object : loaded)
+			{
+				if(object) //list never holds null objects
+					push_back(object);
+			}
+		}
+	}
+
+private:
+	struct Storage
+	{
+		ui32 count;
+		ui32 capacity;
+		//followed by capacity object pointers
+	};
+
+	Storage * storage;
+
+	CGObjectInstance ** objects() const { return storage ? reinterpret_cast<CGObjectInstance **>(storage + 1) : nullptr; }
+	/// makes room for at least given number of objects, keeping current ones
+	void reserve(size_t capacity);
+	void release();
+};
+
 /// The terrain tile describes the terrain type and the visual representation of the terrain.
 /// Furthermore the struct defines whether the tile is visitable or/and blocked and which objects reside in it.
 struct DLL_LINKAGE TerrainTile
@@ -92,8 +169,8 @@ struct DLL_LINKAGE TerrainTile
 	bool visitable;
 	bool blocked;
 
-	std::vector<CGObjectInstance *> visitableObjects;
-	std::vector<CGObjectInstance *> blockingObjects;
+	CTileObjectList visitableObjects;
+	CTileObjectList blockingObjects;
 
 	template <typename Handler>
 	void serialize(Handler & h, const int version)
@@ -0,0 +1,151 @@
+/*
+ * CMapHeaderCache.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+#include "CMapHeaderCache.h"
+
+#include "CMap.h"
+#include "CMapService.h"
+#include "../filesystem/Filesystem.h"
+#include "../serializer/BinaryDeserializer.h"
+#include "../serializer/BinarySerializer.h"
+#include "../serializer/CMemorySerializer.h"
+#include "../CModHandler.h"
+#include "../VCMI_Lib.h"
+
+static const std::string MAP_HEADER_CACHE_MAGIC = "VCMIMHC";
+
+CMapHeaderCache::Entry::Entry():
+	size(0),
+	modificationTime(0),
+	used(false)
+{
+}
+
+CMapHeaderCache::CMapHeaderCache(const boost::filesystem::path & cacheFile):
+	cacheFile(cacheFile),
+	changed(false)
+{
+	for(auto & modName : VLC->modh->getActiveMods())
+		mods.push_back(std::make_pair(modName, VLC->modh->getModData(modName).checksum));
+}
+
+CMapHeaderCache::~CMapHeaderCache() = default;
+
+void CMapHeaderCache::load()
+{
+	entries.clear();
+	changed = false;
+
+	if(!boost::filesystem::exists(cacheFile))
+		return;
+
+	try
+	{
+		CLoadFile file(cacheFile);
+		file.checkMagicBytes(MAP_HEADER_CACHE_MAGIC);
+
+		TModList savedMods;
+		file >> savedMods;
+		if(savedMods != mods)
+		{
+			logGlobal->debug("Mods changed, map header cache is discarded");
+			changed = true;
+			return;
+		}
+		file >> entries;
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->warn("Map header cache %s is not usable: %s", cacheFile.string(), e.what());
+		entries.clear();
+		changed = true;
+	}
+}
+
+void CMapHeaderCache::save()
+{
+	for(auto it = entries.begin(); it != entries.end();)
+	{
+		if(it->second.used)
+		{
+			++it;
+		}
+		else
+		{
+			it = entries.erase(it);
+			changed = true;
+		}
+	}
+
+	if(!changed)
+		return;
+
+	try
+	{
+		boost::filesystem::create_directories(cacheFile.parent_path());
+		CSaveFile file(cacheFile);
+		file.putMagicBytes(MAP_HEADER_CACHE_MAGIC);
+		file << mods << entries;
+		changed = false;
+	}
+	catch(const std::exception & e)
+	{
+		logGlobal->warn("Failed to save map header cache %s: %s", cacheFile.string(), e.what());
+	}
+}
+
+std::unique_ptr<CMapHeader> CMapHeaderCache::loadMapHeader(const ResourceID & name)
+{
+	CMapService mapService;
+
+	//maps from archives have no own file to check, they are always parsed
+	auto path = CResourceHandler::get()->getResourceName(name);
+	if(!path)
+		return mapService.loadMapHeader(name);
+
+	si64 size = 0;
+	si64 modificationTime = 0;
+	try
+	{
+		size = boost::filesystem::file_size(*path);
+		modificationTime = boost::filesystem::last_write_time(*path);
+	}
+	catch(const boost::filesystem::filesystem_error & e)
+	{
+		logGlobal->debug("Can not check map file %s: %s", path->string(), e.what());
+		return mapService.loadMapHeader(name);
+	}
+
+	const std::string key = path->string();
+	{
+		boost::unique_lock<boost::mutex> lock(mx);
+		auto it = entries.find(key);
+		if(it != entries.end() && it->second.size == size && it->second.modificationTime == modificationTime && it->second.header)
+		{
+			it->second.used = true;
+			return CMemorySerializer::deepCopy(*it->second.header);
+		}
+	}
+
+	//parsing is the slow part, so it is done without lock
+	auto header = mapService.loadMapHeader(name);
+
+	Entry entry;
+	entry.size = size;
+	entry.modificationTime = modificationTime;
+	entry.header = CMemorySerializer::deepCopy(*header);
+	entry.used = true;
+
+	boost::unique_lock<boost::mutex> lock(mx);
+	entries[key] = std::move(entry);
+	changed = true;
+
+	return header;
+}
@@ -0,0 +1,57 @@
+/*
+ * CMapHeaderCache.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#pragma once
+
+class ResourceID;
+class CMapHeader;
+
+/// Persistent index of map headers, so maps that did not change since the last scan are not parsed again.
+/// Entries are keyed by path of map file and are valid only while its size and modification time stay the same.
+/// Whole index is dropped when list of active mods or their checksums change
+class DLL_LINKAGE CMapHeaderCache
+{
+public:
+	CMapHeaderCache(const boost::filesystem::path & cacheFile);
+	~CMapHeaderCache();
+
+	/// reads index from disk, missing or outdated index is ignored
+	void load();
+	/// writes index to disk if it changed, entries of maps that were not requested since load() are dropped
+	void save();
+
+	/// returns header from index or parses map and stores its header; can be called from several threads at once
+	std::unique_ptr<CMapHeader> loadMapHeader(const ResourceID & name);
+
+private:
+	struct Entry
+	{
+		si64 size;
+		si64 modificationTime;
+		std::unique_ptr<CMapHeader> header;
+		bool used; //not saved, entry was requested since load()
+
+		Entry();
+
+		template <typename Handler> void serialize(Handler & h, const int version)
+		{
+			h & size;
+			h & modificationTime;
+			h & header;
+		}
+	};
+
+	typedef std::vector<std::pair<std::string, ui32>> TModList;
+
+	boost::filesystem::path cacheFile;
+	TModList mods; //active mods with their checksums
+	std::map<std::string, Entry> entries;
+	bool changed;
+	boost::mutex mx;
+};
@@ -14,6 +14,7 @@
 #include "../StartInfo.h"
 #include "../GameConstants.h"
 #include "CMapService.h"
+#include "CMapHeaderCache.h"
 
 #include "../filesystem/Filesystem.h"
 #include "../serializer/CMemorySerializer.h"
@@ -34,11 +35,18 @@ CMapInfo::~CMapInfo()
 	vstd::clear_pointer(scenarioOptionsOfSave);
 }
 
-void CMapInfo::mapInit(const std::string & fname)
+void CMapInfo::mapInit(const std::string & fname, CMapHeaderCache * headerCache)
 {
 	fileURI = fname;
-	CMapService mapService;
-	mapHeader = mapService.loadMapHeader(ResourceID(fname, EResType::MAP));
+	if(headerCache)
+	{
+		mapHeader = headerCache->loadMapHeader(ResourceID(fname, EResType::MAP));
+	}
+	else
+	{
+		CMapService mapService;
+		mapHeader = mapService.loadMapHeader(ResourceID(fname, EResType::MAP));
+	}
 	countPlayers();
 }
 
@@ -52,7 +60,12 @@ void CMapInfo::saveInit(ResourceID file)
 	fileURI = file.getName();
 	countPlayers();
 	std::time_t time = boost::filesystem::last_write_time(*CResourceHandler::get()->getResourceName(file));
-	date = std::asctime(std::localtime(&time));
+	{
+		//localtime and asctime return shared buffers, saves may be read by several threads
+		static boost::mutex timeMutex;
+		boost::unique_lock<boost::mutex> lock(timeMutex);
+		date = std::asctime(std::localtime(&time));
+	}
 	// We absolutely not need this data for lobby and server will read it from save
 	// FIXME: actually we don't want them in CMapHeader!
 	mapHeader->triggeredEvents.clear();
@@ -21,6 +21,7 @@
 #include "CCampaignHandler.h"
 
 struct StartInfo;
+class CMapHeaderCache;
 
 /**
  * A class which stores the count of human players and all players, the filename,
@@ -44,7 +45,8 @@ public:
 
 	CMapInfo &operator=(CMapInfo &&other);
 
-	void mapInit(const std::string & fname);
+	/// headerCache is used instead of parsing the map if it is given
+	void mapInit(const std::string & fname, CMapHeaderCache * headerCache = nullptr);
 	void saveInit(ResourceID file);
 	void campaignInit();
 	void countPlayers();
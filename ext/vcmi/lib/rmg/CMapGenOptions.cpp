@@ -209,7 +209,7 @@ void CMapGenOptions::setMapTemplate(const CRmgTemplate * value)
 {
 	mapTemplate = value;
 	//TODO validate & adapt options according to template
-	assert(0);
+	assert(!value || value->matchesSize(int3(width, height, hasTwoLevels ? 2 : 1)));
 }
 
 const std::map<std::string, CRmgTemplate *> & CMapGenOptions::getAvailableTemplates() const
@@ -20,42 +20,7 @@
 #include "CZonePlacer.h"
 #include "CRmgTemplateZone.h"
 #include "../mapObjects/CObjectClassesHandler.h"
-
-static const int3 dirs4[] = {int3(0,1,0),int3(0,-1,0),int3(-1,0,0),int3(+1,0,0)};
-static const int3 dirsDiagonal[] = { int3(1,1,0),int3(1,-1,0),int3(-1,1,0),int3(-1,-1,0) };
-
-void CMapGenerator::foreach_neighbour(const int3 &pos, std::function<void(int3& pos)> foo)
-{
-	for(const int3 &dir : int3::getDirs())
-	{
-		int3 n = pos + dir;
-		/*important notice: perform any translation before this function is called,
-		so the actual map position is checked*/
-		if(map->isInTheMap(n))
-			foo(n);
-	}
-}
-
-void CMapGenerator::foreachDirectNeighbour(const int3& pos, std::function<void(int3& pos)> foo)
-{
-	for(const int3 &dir : dirs4)
-	{
-		int3 n = pos + dir;
-		if(map->isInTheMap(n))
-			foo(n);
-	}
-}
-
-void CMapGenerator::foreachDiagonaltNeighbour(const int3& pos, std::function<void(int3& pos)> foo)
-{
-	for (const int3 &dir : dirsDiagonal)
-	{
-		int3 n = pos + dir;
-		if (map->isInTheMap(n))
-			foo(n);
-	}
-}
-
+#include "../CThreadHelper.h"
 
 CMapGenerator::CMapGenerator() :
 	mapGenOptions(nullptr), randomSeed(0), editManager(nullptr),
@@ -72,6 +37,7 @@ void CMapGenerator::initTiles()
 	int height = map->height;
 
 	int level = map->twoLevel ? 2 : 1;
+	mapSize = int3(width, height, level);
 	tiles = new CTileInfo**[width];
 	for (int i = 0; i < width; ++i)
 	{
@@ -130,6 +96,9 @@ std::unique_ptr<CMap> CMapGenerator::generate(CMapGenOptions * mapGenOptions, in
 
 	assert(mapGenOptions);
 
+	phaseTimes.clear();
+	phaseStart = boost::chrono::steady_clock::now();
+
 	rand.setSeed(this->randomSeed);
 	mapGenOptions->finalize(rand);
 
@@ -145,7 +114,9 @@ std::unique_ptr<CMap> CMapGenerator::generate(CMapGenOptions * mapGenOptions, in
 
 		initPrisonsRemaining();
 		initQuestArtsRemaining();
+		finishPhase("initialization");
 		genZones();
+		finishPhase("zone placement");
 		map->calculateGuardingGreaturePositions(); //clear map so that all tiles are unguarded
 		fillZones();
 		//updated guarded tiles will be calculated in CGameState::initMapObjects()
@@ -317,7 +288,11 @@ void CMapGenerator::fillZones()
 		it.second->createBorder(); //once direct connections are done
 
 	createConnections2(); //subterranean gates and monoliths
+	finishPhase("connections");
 
+	//filling and obstacle placement stay sequential: zones draw from shared random generator, insert objects
+	//through shared editManager and mark occupied tiles and object distances across zone borders,
+	//so running them concurrently would change generated map for given seed
 	std::vector<std::shared_ptr<CRmgTemplateZone>> treasureZones;
 	for (auto it : zones)
 	{
@@ -325,6 +300,7 @@ void CMapGenerator::fillZones()
 		if (it.second->getType() == ETemplateZoneType::TREASURE)
 			treasureZones.push_back(it.second);
 	}
+	finishPhase("fill");
 
 	//set apriopriate free/occupied tiles, including blocked underground rock
 	createObstaclesCommon1();
@@ -337,6 +313,7 @@ void CMapGenerator::fillZones()
 	{
 		it.second->createObstacles2();
 	}
+	finishPhase("obstacles");
 
 	#define PRINT_MAP_BEFORE_ROADS false
 	if (PRINT_MAP_BEFORE_ROADS) //enable to debug
@@ -373,10 +350,8 @@ void CMapGenerator::fillZones()
 		out << std::endl;
 	}
 
-	for (auto it : zones)
-	{
-		it.second->connectRoads(); //draw roads after everything else has been placed
-	}
+	connectRoads(); //draw roads after everything else has been placed
+	finishPhase("roads");
 
 	//find place for Grail
 	if (treasureZones.empty())
@@ -391,6 +366,52 @@ void CMapGenerator::fillZones()
 	logGlobal->info("Zones filled successfully");
 }
 
+void CMapGenerator::connectRoads()
+{
+	//road search reads and writes road state only of tiles of its own zone, so zones can be processed in parallel
+	std::vector<Task> tasks;
+	std::vector<std::exception_ptr> errors(zones.size());
+
+	size_t index = 0;
+	for (auto it : zones)
+	{
+		auto zone = it.second;
+		auto error = &errors[index++];
+
+		tasks.push_back([zone, error]()
+		{
+			try
+			{
+				zone->connectRoads();
+			}
+			catch (...)
+			{
+				*error = std::current_exception();
+			}
+		});
+	}
+
+	uint32_t threadCount = boost::thread::hardware_concurrency();
+
+	vstd::amin(threadCount, tasks.size());
+	vstd::amax(threadCount, 1);
+
+	CThreadHelper threadHelper(&tasks, threadCount);
+	threadHelper.run();
+
+	for (auto & error : errors)
+	{
+		if (error)
+			std::rethrow_exception(error);
+	}
+
+	//editManager and random generator are shared, keep drawing sequential and in zone order
+	for (auto it : zones)
+		it.second->applyForeignRoads();
+	for (auto it : zones)
+		it.second->drawRoads();
+}
+
 void CMapGenerator::createObstaclesCommon1()
 {
 	if (map->twoLevel) //underground
@@ -503,12 +524,12 @@ void CMapGenerator::createDirectConnections()
 		auto zoneB = zones[connection.getZoneB()];
 
 		//rearrange tiles in random order
-		auto tilesCopy = zoneA->getTileInfo();
+		const auto & tilesCopy = zoneA->getTileInfo();
 		std::vector<int3> tiles(tilesCopy.begin(), tilesCopy.end());
 
 		int3 guardPos(-1,-1,-1);
 
-		auto otherZoneTiles = zoneB->getTileInfo();
+		const auto & otherZoneTiles = zoneB->getTileInfo();
 
 		int3 posA = zoneA->getPos();
 		int3 posB = zoneB->getPos();
@@ -602,8 +623,8 @@ void CMapGenerator::createConnections2()
 			{
 				bool continueOuterLoop = false;
 				//find common tiles for both zones
-				auto tileSetA = zoneA->getPossibleTiles(),
-					tileSetB = zoneB->getPossibleTiles();
+				const auto & tileSetA = zoneA->getPossibleTiles();
+				const auto & tileSetB = zoneB->getPossibleTiles();
 
 				std::vector<int3> tilesA(tileSetA.begin(), tileSetA.end()),
 					tilesB(tileSetB.begin(), tileSetB.end());
@@ -717,6 +738,26 @@ void CMapGenerator::checkIsOnMap(const int3& tile) const
 }
 
 
+const std::vector<std::pair<std::string, si64>> & CMapGenerator::getPhaseTimes() const
+{
+	return phaseTimes;
+}
+
+void CMapGenerator::finishPhase(const std::string & name)
+{
+	auto now = boost::chrono::steady_clock::now();
+	si64 duration = boost::chrono::duration_cast<boost::chrono::milliseconds>(now - phaseStart).count();
+
+	logGlobal->debug("Map generation phase %s took %d ms", name, duration);
+	phaseTimes.push_back(std::make_pair(name, duration));
+	phaseStart = now;
+}
+
+int3 CMapGenerator::getMapSize() const
+{
+	return mapSize;
+}
+
 CMapGenerator::Zones & CMapGenerator::getZones()
 {
 	return zones;
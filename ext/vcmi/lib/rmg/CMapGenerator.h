@@ -67,9 +67,52 @@ public:
 	void createDirectConnections();
 	void createConnections2();
 	void findZonesForQuestArts();
-	void foreach_neighbour(const int3 &pos, std::function<void(int3& pos)> foo);
-	void foreachDirectNeighbour(const int3 &pos, std::function<void(int3& pos)> foo);
-	void foreachDiagonaltNeighbour(const int3& pos, std::function<void(int3& pos)> foo);
+
+	/// neighbour iteration is done for almost every tile by every path search, keep it inlined
+	template<typename Func>
+	void foreach_neighbour(const int3 &pos, Func foo)
+	{
+		for(const int3 &dir : int3::getDirs())
+		{
+			int3 n = pos + dir;
+			/*important notice: perform any translation before this function is called,
+			so the actual map position is checked*/
+			if(isOnMap(n))
+				foo(n);
+		}
+	}
+
+	template<typename Func>
+	void foreachDirectNeighbour(const int3 &pos, Func foo)
+	{
+		static const int3 dirs4[] = {int3(0,1,0),int3(0,-1,0),int3(-1,0,0),int3(+1,0,0)};
+
+		for(const int3 &dir : dirs4)
+		{
+			int3 n = pos + dir;
+			if(isOnMap(n))
+				foo(n);
+		}
+	}
+
+	template<typename Func>
+	void foreachDiagonaltNeighbour(const int3& pos, Func foo)
+	{
+		static const int3 dirsDiagonal[] = { int3(1,1,0),int3(1,-1,0),int3(-1,1,0),int3(-1,-1,0) };
+
+		for (const int3 &dir : dirsDiagonal)
+		{
+			int3 n = pos + dir;
+			if (isOnMap(n))
+				foo(n);
+		}
+	}
+
+	bool isOnMap(const int3 &tile) const
+	{
+		return tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < mapSize.x && tile.y < mapSize.y && tile.z < mapSize.z;
+	}
+	int3 getMapSize() const; //width, height and number of levels
 
 	bool isBlocked(const int3 &tile) const;
 	bool shouldBeBlocked(const int3 &tile) const;
@@ -100,20 +143,28 @@ public:
 	TRmgTemplateZoneId getZoneID(const int3& tile) const;
 	void setZoneID(const int3& tile, TRmgTemplateZoneId zid);
 
+	/// wall clock time in milliseconds spent in each phase of last generate() call, in order of execution
+	const std::vector<std::pair<std::string, si64>> & getPhaseTimes() const;
+
 private:
 	std::list<rmg::ZoneConnection> connectionsLeft;
 	Zones zones;
 	std::map<TFaction, ui32> zonesPerFaction;
 	ui32 zonesTotal; //zones that have their main town only
 
+	int3 mapSize;
 	CTileInfo*** tiles;
 	boost::multi_array<TRmgTemplateZoneId, 3> zoneColouring; //[z][x][y]
 
+	std::vector<std::pair<std::string, si64>> phaseTimes;
+	boost::chrono::steady_clock::time_point phaseStart;
+
 	int prisonsRemaining;
 	//int questArtsRemaining;
 	int monolithIndex;
 	std::vector<ArtifactID> questArtifacts;
 	void checkIsOnMap(const int3 &tile) const; //throws
+	void finishPhase(const std::string & name); //records time spent since previous phase was finished
 
 	/// Generation methods
 	std::string getMapDescription() const;
@@ -125,6 +176,7 @@ private:
 	void initTiles();
 	void genZones();
 	void fillZones();
+	void connectRoads();
 	void createObstaclesCommon1();
 	void createObstaclesCommon2();
 
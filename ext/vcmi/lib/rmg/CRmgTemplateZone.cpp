@@ -122,6 +122,13 @@ void CRmgTemplateZone::setOptions(const ZoneOptions * options)
 void CRmgTemplateZone::setGenPtr(CMapGenerator * Gen)
 {
 	gen = Gen;
+
+	int3 mapSize = gen->getMapSize();
+	tileinfo = CTileSet(mapSize);
+	possibleTiles = CTileSet(mapSize);
+	freePaths = CTileSet(mapSize);
+	roads = CTileSet(mapSize);
+	tilesToConnectLater = CTileSet(mapSize);
 }
 
 void CRmgTemplateZone::setQuestArtZone(std::shared_ptr<CRmgTemplateZone> otherZone)
@@ -129,7 +136,7 @@ void CRmgTemplateZone::setQuestArtZone(std::shared_ptr<CRmgTemplateZone> otherZo
 	questArtZone = otherZone;
 }
 
-std::set<int3>* CRmgTemplateZone::getFreePaths()
+CTileSet* CRmgTemplateZone::getFreePaths()
 {
 	return &freePaths;
 }
@@ -174,11 +181,11 @@ void CRmgTemplateZone::addTile (const int3 &pos)
 	tileinfo.insert(pos);
 }
 
-std::set<int3> CRmgTemplateZone::getTileInfo () const
+const CTileSet & CRmgTemplateZone::getTileInfo () const
 {
 	return tileinfo;
 }
-std::set<int3> CRmgTemplateZone::getPossibleTiles() const
+const CTileSet & CRmgTemplateZone::getPossibleTiles() const
 {
 	return possibleTiles;
 }
@@ -195,7 +202,7 @@ void CRmgTemplateZone::discardDistantTiles (float distance)
 	//		//gen->setOccupied(tile, ETileType::BLOCKED); //fixme: crash at rendering?
 	//	}
 	//}
-	vstd::erase_if (tileinfo, [distance, this](const int3 &tile) -> bool
+	tileinfo.eraseIf([distance, this](const int3 &tile) -> bool
 	{
 		return tile.dist2d(this->pos) > distance;
 	});
@@ -208,10 +215,11 @@ void CRmgTemplateZone::clearTiles()
 
 void CRmgTemplateZone::initFreeTiles ()
 {
-	vstd::copy_if (tileinfo, vstd::set_inserter(possibleTiles), [this](const int3 &tile) -> bool
+	for (auto tile : tileinfo)
 	{
-		return gen->isPossible(tile);
-	});
+		if (gen->isPossible(tile))
+			possibleTiles.insert(tile);
+	}
 	if (freePaths.empty())
 	{
 		gen->setOccupied(pos, ETileType::FREE);
@@ -251,8 +259,8 @@ void CRmgTemplateZone::fractalize()
 			freePaths.insert(tile);
 	}
 	std::vector<int3> clearedTiles (freePaths.begin(), freePaths.end());
-	std::set<int3> possibleTiles;
-	std::set<int3> tilesToIgnore; //will be erased in this iteration
+	CTileSet possibleTiles(gen->getMapSize());
+	CTileSet tilesToIgnore(gen->getMapSize()); //will be erased in this iteration
 
 	//the more treasure density, the greater distance between paths. Scaling is experimental.
 	int totalDensity = 0;
@@ -318,7 +326,7 @@ void CRmgTemplateZone::fractalize()
 			for (auto tileToClear : tilesToIgnore)
 			{
 				//these tiles are already connected, ignore them
-				vstd::erase_if_present(possibleTiles, tileToClear);
+				possibleTiles.erase(tileToClear);
 			}
 			if (!nodeFound.valid()) //nothing else can be done (?)
 				break;
@@ -426,7 +434,7 @@ void CRmgTemplateZone::connectLater()
 	}
 }
 
-bool CRmgTemplateZone::crunchPath(const int3 &src, const int3 &dst, bool onlyStraight, std::set<int3>* clearedTiles)
+bool CRmgTemplateZone::crunchPath(const int3 &src, const int3 &dst, bool onlyStraight, CTileSet* clearedTiles)
 {
 /*
 make shortest path with free tiles, reachning dst or closest already free tile. Avoid blocks.
@@ -534,6 +542,31 @@ do not leave zone border
 
 	return result;
 }
+namespace
+{
+	struct PathNode
+	{
+		int3 cameFrom;
+		float distance; //cost from start along best known path
+		bool closed; //node was already evaluated
+
+		PathNode() : cameFrom(-1, -1, -1), distance(0.f), closed(false)
+		{
+		}
+	};
+
+	//path searches are run for almost every placed object, so keep their buffers between searches
+	CTileMap<PathNode> & getPathNodes(const int3 & mapSize)
+	{
+		static boost::thread_specific_ptr<CTileMap<PathNode>> nodes;
+
+		if (!nodes.get())
+			nodes.reset(new CTileMap<PathNode>());
+		nodes->resize(mapSize);
+		return *nodes;
+	}
+}
+
 boost::heap::priority_queue<CRmgTemplateZone::TDistance, boost::heap::compare<CRmgTemplateZone::NodeComparer>> CRmgTemplateZone::createPiorityQueue()
 {
 	return boost::heap::priority_queue<TDistance, boost::heap::compare<NodeComparer>>();
@@ -543,16 +576,17 @@ bool CRmgTemplateZone::createRoad(const int3& src, const int3& dst)
 {
 	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
 
-	std::set<int3> closed;    // The set of nodes already evaluated.
+	auto & nodes = getPathNodes(gen->getMapSize()); // The map of navigated nodes.
 	auto pq = std::move(createPiorityQueue());    // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
 
-	gen->setRoad (src, ERoadType::NO_ROAD); //just in case zone guard already has road under it. Road under nodes will be added at very end
+	//just in case zone guard already has road under it. Road under nodes will be added at very end
+	//road state of tiles owned by other zones is only read and written after all zones are connected
+	if (gen->getZoneID(src) == id)
+		gen->setRoad (src, ERoadType::NO_ROAD);
 
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
+	nodes[src].cameFrom = int3(-1, -1, -1); //first node points to finish condition
 	pq.push(std::make_pair(src, 0.f));
-	distances[src] = 0.f;
+	nodes[src].distance = 0.f;
 	// Cost from start along best known path.
 
 	while (!pq.empty())
@@ -560,22 +594,22 @@ bool CRmgTemplateZone::createRoad(const int3& src, const int3& dst)
 		auto node = pq.top();
 		pq.pop(); //remove top element
 		int3 currentNode = node.first;
-		closed.insert (currentNode);
+		nodes[currentNode].closed = true;
 		auto currentTile = &gen->map->getTile(currentNode);
 
-		if (currentNode == dst || gen->isRoad(currentNode))
+		if (currentNode == dst || (gen->getZoneID(currentNode) == id && gen->isRoad(currentNode)))
 		{
 			// The goal node was reached. Trace the path using
 			// the saved parent information and return path
 			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
+			while (nodes[backTracking].cameFrom.valid())
 			{
 				// add node to path
 				roads.insert (backTracking);
-				gen->setRoad (backTracking, ERoadType::COBBLESTONE_ROAD);
+				addRoad (backTracking);
 				//logGlobal->trace("Setting road at tile %s", backTracking);
 				// do the same for the predecessor
-				backTracking = cameFrom[backTracking];
+				backTracking = nodes[backTracking].cameFrom;
 			}
 			return true;
 		}
@@ -584,15 +618,15 @@ bool CRmgTemplateZone::createRoad(const int3& src, const int3& dst)
 			bool directNeighbourFound = false;
 			float movementCost = 1;
 
-			auto foo = [this, &pq, &distances, &closed, &cameFrom, &currentNode, &currentTile, &node, &dst, &directNeighbourFound, &movementCost](int3& pos) -> void
+			auto foo = [this, &pq, &nodes, &currentNode, &currentTile, &node, &dst, &directNeighbourFound, &movementCost](int3& pos) -> void
 			{
-				if (vstd::contains(closed, pos)) //we already visited that node
+				auto visited = nodes.find(pos);
+				if (visited && visited->closed) //we already visited that node
 					return;
 				float distance = node.second + movementCost;
 				float bestDistanceSoFar = std::numeric_limits<float>::max();
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
+				if (visited)
+					bestDistanceSoFar = visited->distance;
 
 				if (distance < bestDistanceSoFar)
 				{
@@ -605,8 +639,8 @@ bool CRmgTemplateZone::createRoad(const int3& src, const int3& dst)
 					{
 						if (gen->getZoneID(pos) == id || pos == dst) //otherwise guard position may appear already connected to other zone.
 						{
-							cameFrom[pos] = currentNode;
-							distances[pos] = distance;
+							nodes[pos].cameFrom = currentNode;
+							nodes[pos].distance = distance;
 							pq.push(std::make_pair(pos, distance));
 							directNeighbourFound = true;
 						}
@@ -633,15 +667,14 @@ bool CRmgTemplateZone::connectPath(const int3& src, bool onlyStraight)
 {
 	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
 
-	std::set<int3> closed;    // The set of nodes already evaluated.
+	std::vector<int3> closed;    // The set of nodes already evaluated.
 	auto open = std::move(createPiorityQueue());    // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
+	auto & nodes = getPathNodes(gen->getMapSize()); // The map of navigated nodes.
 
 	//int3 currentNode = src;
 
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
-	distances[src] = 0.f;
+	nodes[src].cameFrom = int3(-1, -1, -1); //first node points to finish condition
+	nodes[src].distance = 0.f;
 	open.push(std::make_pair(src, 0.f));
 	// Cost from start along best known path.
 	// Estimated total cost from start to goal through y.
@@ -652,41 +685,45 @@ bool CRmgTemplateZone::connectPath(const int3& src, bool onlyStraight)
 		open.pop();
 		int3 currentNode = node.first;
 
-		closed.insert(currentNode);
+		if (!nodes[currentNode].closed)
+		{
+			nodes[currentNode].closed = true;
+			closed.push_back(currentNode);
+		}
 
 		if (gen->isFree(currentNode)) //we reached free paths, stop
 		{
 			// Trace the path using the saved parent information and return path
 			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
+			while (nodes[backTracking].cameFrom.valid())
 			{
 				gen->setOccupied(backTracking, ETileType::FREE);
-				backTracking = cameFrom[backTracking];
+				backTracking = nodes[backTracking].cameFrom;
 			}
 			return true;
 		}
 		else
 		{
-			auto foo = [this, &open, &closed, &cameFrom, &currentNode, &distances](int3& pos) -> void
+			auto foo = [this, &open, &nodes, &currentNode](int3& pos) -> void
 			{
-				if (vstd::contains(closed, pos))
+				auto visited = nodes.find(pos);
+				if (visited && visited->closed)
 					return;
 
 				//no paths through blocked or occupied tiles, stay within zone
 				if (gen->isBlocked(pos) || gen->getZoneID(pos) != id)
 					return;
 
-				int distance = distances[currentNode] + 1;
+				int distance = nodes[currentNode].distance + 1;
 				int bestDistanceSoFar = std::numeric_limits<int>::max();
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
+				if (visited)
+					bestDistanceSoFar = visited->distance;
 
 				if (distance < bestDistanceSoFar)
 				{
-					cameFrom[pos] = currentNode;
+					nodes[pos].cameFrom = currentNode;
 					open.push(std::make_pair(pos, distance));
-					distances[pos] = distance;
+					nodes[pos].distance = distance;
 				}
 			};
 
@@ -700,7 +737,7 @@ bool CRmgTemplateZone::connectPath(const int3& src, bool onlyStraight)
 	for (auto tile : closed) //these tiles are sealed off and can't be connected anymore
 	{
 		gen->setOccupied (tile, ETileType::BLOCKED);
-		vstd::erase_if_present(possibleTiles, tile);
+		possibleTiles.erase(tile);
 	}
 	return false;
 }
@@ -710,13 +747,11 @@ bool CRmgTemplateZone::connectWithCenter(const int3& src, bool onlyStraight)
 {
 	//A* algorithm taken from Wiki http://en.wikipedia.org/wiki/A*_search_algorithm
 
-	std::set<int3> closed;    // The set of nodes already evaluated.
 	auto open = std::move(createPiorityQueue()); // The set of tentative nodes to be evaluated, initially containing the start node
-	std::map<int3, int3> cameFrom;  // The map of navigated nodes.
-	std::map<int3, float> distances;
+	auto & nodes = getPathNodes(gen->getMapSize()); // The map of navigated nodes.
 
-	cameFrom[src] = int3(-1, -1, -1); //first node points to finish condition
-	distances[src] = 0;
+	nodes[src].cameFrom = int3(-1, -1, -1); //first node points to finish condition
+	nodes[src].distance = 0;
 	open.push(std::make_pair(src, 0.f));
 	// Cost from start along best known path.
 
@@ -726,24 +761,25 @@ bool CRmgTemplateZone::connectWithCenter(const int3& src, bool onlyStraight)
 		open.pop();
 		int3 currentNode = node.first;
 
-		closed.insert(currentNode);
+		nodes[currentNode].closed = true;
 
 		if (currentNode == pos) //we reached center of the zone, stop
 		{
 			// Trace the path using the saved parent information and return path
 			int3 backTracking = currentNode;
-			while (cameFrom[backTracking].valid())
+			while (nodes[backTracking].cameFrom.valid())
 			{
 				gen->setOccupied(backTracking, ETileType::FREE);
-				backTracking = cameFrom[backTracking];
+				backTracking = nodes[backTracking].cameFrom;
 			}
 			return true;
 		}
 		else
 		{
-			auto foo = [this, &open, &closed, &cameFrom, &currentNode, &distances](int3& pos) -> void
+			auto foo = [this, &open, &nodes, &currentNode](int3& pos) -> void
 			{
-				if (vstd::contains(closed, pos))
+				auto visited = nodes.find(pos);
+				if (visited && visited->closed)
 					return;
 
 				if (gen->getZoneID(pos) != id)
@@ -757,17 +793,16 @@ bool CRmgTemplateZone::connectWithCenter(const int3& src, bool onlyStraight)
 				else
 					return;
 
-				float distance = distances[currentNode] + movementCost; //we prefer to use already free paths
+				float distance = nodes[currentNode].distance + movementCost; //we prefer to use already free paths
 				int bestDistanceSoFar = std::numeric_limits<int>::max(); //FIXME: boost::limits
-				auto it = distances.find(pos);
-				if (it != distances.end())
-					bestDistanceSoFar = it->second;
+				if (visited)
+					bestDistanceSoFar = visited->distance;
 
 				if (distance < bestDistanceSoFar)
 				{
-					cameFrom[pos] = currentNode;
+					nodes[pos].cameFrom = currentNode;
 					open.push(std::make_pair(pos, distance));
-					distances[pos] = distance;
+					nodes[pos].distance = distance;
 				}
 			};
 
@@ -1094,7 +1129,7 @@ bool CRmgTemplateZone::createTreasurePile(int3 &pos, float minDistance, const CT
 	else //we did not place eveyrthing successfully
 	{
 		gen->setOccupied(pos, ETileType::BLOCKED); //TODO: refactor stop condition
-		vstd::erase_if_present(possibleTiles, pos);
+		possibleTiles.erase(pos);
 		return false;
 	}
 }
@@ -1505,7 +1540,7 @@ void CRmgTemplateZone::createTreasures()
 		bool stop = false;
 		do {
 			//optimization - don't check tiles which are not allowed
-			vstd::erase_if(possibleTiles, [this](const int3 &tile) -> bool
+			possibleTiles.eraseIf([this](const int3 &tile) -> bool
 			{
 				return !gen->isPossible(tile);
 			});
@@ -1657,11 +1692,26 @@ void CRmgTemplateZone::connectRoads()
 		processed.insert(node);
 	}
 
-	drawRoads();
-
 	logGlobal->debug("Finished building roads");
 }
 
+void CRmgTemplateZone::addRoad(const int3& tile)
+{
+	//other zones may be searching their roads at the same time, so only touch our own tiles here
+	if (gen->getZoneID(tile) == id)
+		gen->setRoad(tile, ERoadType::COBBLESTONE_ROAD);
+	else
+		foreignRoads.push_back(tile);
+}
+
+void CRmgTemplateZone::applyForeignRoads()
+{
+	for (auto & tile : foreignRoads)
+		gen->setRoad(tile, ERoadType::COBBLESTONE_ROAD);
+
+	foreignRoads.clear();
+}
+
 void CRmgTemplateZone::drawRoads()
 {
 	std::vector<int3> tiles;
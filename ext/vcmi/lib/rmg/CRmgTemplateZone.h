@@ -12,6 +12,7 @@
 
 #include "../GameConstants.h"
 #include "CMapGenerator.h"
+#include "CTileSet.h"
 #include "float3.h"
 #include "../int3.h"
 #include "CRmgTemplate.h"
@@ -104,8 +105,8 @@ public:
 
 	void addTile (const int3 &pos);
 	void initFreeTiles ();
-	std::set<int3> getTileInfo() const;
-	std::set<int3> getPossibleTiles() const;
+	const CTileSet & getTileInfo() const;
+	const CTileSet & getPossibleTiles() const;
 	void discardDistantTiles (float distance);
 	void clearTiles();
 
@@ -128,7 +129,7 @@ public:
 	void createTreasures();
 	void createObstacles1();
 	void createObstacles2();
-	bool crunchPath(const int3 &src, const int3 &dst, bool onlyStraight, std::set<int3>* clearedTiles = nullptr);
+	bool crunchPath(const int3 &src, const int3 &dst, bool onlyStraight, CTileSet* clearedTiles = nullptr);
 	bool connectPath(const int3& src, bool onlyStraight);
 	bool connectWithCenter(const int3& src, bool onlyStraight);
 	void updateDistances(const int3 & pos);
@@ -137,7 +138,7 @@ public:
 	bool areAllTilesAvailable(CGObjectInstance* obj, int3& tile, std::set<int3>& tilesBlockedByObject) const;
 
 	void setQuestArtZone(std::shared_ptr<CRmgTemplateZone> otherZone);
-	std::set<int3>* getFreePaths();
+	CTileSet* getFreePaths();
 
 	ObjectInfo getRandomObject (CTreasurePileInfo &info, ui32 desiredValue, ui32 maxValue, ui32 currentValue);
 
@@ -146,7 +147,9 @@ public:
 	bool guardObject(CGObjectInstance* object, si32 str, bool zoneGuard = false, bool addToFreePaths = false);
 	void placeAndGuardObject(CGObjectInstance* object, const int3 &pos, si32 str, bool zoneGuard = false);
 	void addRoadNode(const int3 & node);
-	void connectRoads(); //fills "roads" according to "roadNodes"
+	void connectRoads(); //fills "roads" according to "roadNodes", safe to run concurrently for different zones
+	void applyForeignRoads(); //updates road state of tiles outside of zone found by connectRoads
+	void drawRoads(); //actually updates tiles
 
 	//A* priority queue
 	typedef std::pair<int3, float> TDistance;
@@ -178,16 +181,17 @@ private:
 	//placement info
 	int3 pos;
 	float3 center;
-	std::set<int3> tileinfo; //irregular area assined to zone
-	std::set<int3> possibleTiles; //optimization purposes for treasure generation
-	std::set<int3> freePaths; //core paths of free tiles that all other objects will be linked to
+	CTileSet tileinfo; //irregular area assined to zone
+	CTileSet possibleTiles; //optimization purposes for treasure generation
+	CTileSet freePaths; //core paths of free tiles that all other objects will be linked to
 
 	std::set<int3> roadNodes; //tiles to be connected with roads
-	std::set<int3> roads; //all tiles with roads
-	std::set<int3> tilesToConnectLater; //will be connected after paths are fractalized
+	CTileSet roads; //all tiles with roads
+	CTileSet tilesToConnectLater; //will be connected after paths are fractalized
+	std::vector<int3> foreignRoads; //roads found on tiles owned by other zones, applied after all zones are connected
 
 	bool createRoad(const int3 &src, const int3 &dst);
-	void drawRoads(); //actually updates tiles
+	void addRoad(const int3 &tile);
 
 	bool pointIsIn(int x, int y);
 	void addAllPossibleObjects (); //add objects, including zone-specific, to possibleObjects
@@ -0,0 +1,330 @@
+/*
+ * CTileSet.h, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#pragma once
+
+#include "../int3.h"
+
+/// Set of map tiles stored as one bit per tile of the whole map.
+/// Tiles are iterated in the same order as in std::set<int3>: by level, then by row, then by column
+class CTileSet
+{
+public:
+	typedef int3 value_type;
+
+	class const_iterator
+	{
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef int3 value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const int3 * pointer;
+		typedef int3 reference; //tiles are not stored anywhere, so they are returned by value
+
+		const_iterator():
+			owner(nullptr), position(0)
+		{
+		}
+
+		int3 operator*() const
+		{
+			return owner->tileAt(position);
+		}
+
+		const_iterator & operator++()
+		{
+			position = owner->findNext(position + 1);
+			return *this;
+		}
+
+		const_iterator operator++(int)
+		{
+			const_iterator ret = *this;
+			++*this;
+			return ret;
+		}
+
+		const_iterator & operator--()
+		{
+			position = owner->findPrevious(position);
+			return *this;
+		}
+
+		const_iterator operator--(int)
+		{
+			const_iterator ret = *this;
+			--*this;
+			return ret;
+		}
+
+		bool operator==(const const_iterator & other) const
+		{
+			return position == other.position && owner == other.owner;
+		}
+
+		bool operator!=(const const_iterator & other) const
+		{
+			return !(*this == other);
+		}
+
+	private:
+		friend class CTileSet;
+
+		const_iterator(const CTileSet * Owner, size_t Position):
+			owner(Owner), position(Position)
+		{
+		}
+
+		const CTileSet * owner;
+		size_t position;
+	};
+
+	typedef const_iterator iterator;
+
+	CTileSet():
+		mapSize(0, 0, 0), tilesCount(0), setCount(0)
+	{
+	}
+
+	/// mapSize holds width, height and number of levels of the map
+	explicit CTileSet(const int3 & MapSize):
+		mapSize(MapSize), tilesCount(MapSize.x * MapSize.y * MapSize.z), setCount(0), bits((tilesCount + BITS_PER_WORD - 1) / BITS_PER_WORD, 0)
+	{
+	}
+
+	/// returns true if tile was not present in set before
+	bool insert(const int3 & tile)
+	{
+		size_t i = index(tile);
+		ui64 mask = ui64(1) << (i % BITS_PER_WORD);
+		ui64 & word = bits[i / BITS_PER_WORD];
+		if (word & mask)
+			return false;
+		word |= mask;
+		setCount++;
+		return true;
+	}
+
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last)
+	{
+		for (; first != last; ++first)
+			insert(*first);
+	}
+
+	/// returns true if tile was present in set
+	bool erase(const int3 & tile)
+	{
+		size_t i = index(tile);
+		ui64 mask = ui64(1) << (i % BITS_PER_WORD);
+		ui64 & word = bits[i / BITS_PER_WORD];
+		if (!(word & mask))
+			return false;
+		word &= ~mask;
+		setCount--;
+		return true;
+	}
+
+	template<typename Predicate>
+	void eraseIf(Predicate pred)
+	{
+		for (size_t i = findNext(0); i != tilesCount; i = findNext(i + 1))
+		{
+			if (pred(tileAt(i)))
+			{
+				bits[i / BITS_PER_WORD] &= ~(ui64(1) << (i % BITS_PER_WORD));
+				setCount--;
+			}
+		}
+	}
+
+	/// tiles outside of the map are never contained
+	bool contains(const int3 & tile) const
+	{
+		if (tile.x < 0 || tile.y < 0 || tile.z < 0 || tile.x >= mapSize.x || tile.y >= mapSize.y || tile.z >= mapSize.z)
+			return false;
+		size_t i = index(tile);
+		return (bits[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1;
+	}
+
+	void clear()
+	{
+		std::fill(bits.begin(), bits.end(), 0);
+		setCount = 0;
+	}
+
+	bool empty() const
+	{
+		return setCount == 0;
+	}
+
+	size_t size() const
+	{
+		return setCount;
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, findNext(0));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, tilesCount);
+	}
+
+private:
+	static const size_t BITS_PER_WORD = 64;
+
+	int3 mapSize;
+	size_t tilesCount;
+	size_t setCount;
+	std::vector<ui64> bits;
+
+	size_t index(const int3 & tile) const
+	{
+		assert(tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < mapSize.x && tile.y < mapSize.y && tile.z < mapSize.z);
+		return (static_cast<size_t>(tile.z) * mapSize.y + tile.y) * mapSize.x + tile.x;
+	}
+
+	int3 tileAt(size_t i) const
+	{
+		return int3(i % mapSize.x, (i / mapSize.x) % mapSize.y, i / (mapSize.x * mapSize.y));
+	}
+
+	/// first tile in set with index not lower than given one, tilesCount if there is none
+	size_t findNext(size_t from) const
+	{
+		size_t wordIndex = from / BITS_PER_WORD;
+		if (wordIndex >= bits.size())
+			return tilesCount;
+
+		ui64 word = bits[wordIndex] & (~ui64(0) << (from % BITS_PER_WORD));
+		while (!word)
+		{
+			if (++wordIndex == bits.size())
+				return tilesCount;
+			word = bits[wordIndex];
+		}
+
+		size_t bit = 0;
+		while (!(word & 0xff))
+		{
+			word >>= 8;
+			bit += 8;
+		}
+		while (!(word & 1))
+		{
+			word >>= 1;
+			bit++;
+		}
+		return wordIndex * BITS_PER_WORD + bit;
+	}
+
+	/// last tile in set with index lower than given one, set must contain such tile
+	size_t findPrevious(size_t from) const
+	{
+		assert(from > 0);
+		size_t last = from - 1;
+		size_t wordIndex = last / BITS_PER_WORD;
+
+		ui64 word = bits[wordIndex] & (~ui64(0) >> (BITS_PER_WORD - 1 - last % BITS_PER_WORD));
+		while (!word)
+		{
+			assert(wordIndex > 0);
+			word = bits[--wordIndex];
+		}
+
+		size_t bit = BITS_PER_WORD - 1;
+		while (!(word & (ui64(0xff) << 56)))
+		{
+			word <<= 8;
+			bit -= 8;
+		}
+		while (!(word & (ui64(1) << 63)))
+		{
+			word <<= 1;
+			bit--;
+		}
+		return wordIndex * BITS_PER_WORD + bit;
+	}
+};
+
+/// Values attached to map tiles, stored in flat arrays over the whole map.
+/// clear() takes constant time, so single instance can be reused by many path searches
+template<typename T>
+class CTileMap
+{
+public:
+	CTileMap():
+		mapSize(0, 0, 0), generation(1)
+	{
+	}
+
+	/// mapSize holds width, height and number of levels of the map. Removes all values
+	void resize(const int3 & MapSize)
+	{
+		if (mapSize != MapSize)
+		{
+			mapSize = MapSize;
+			size_t tilesCount = MapSize.x * MapSize.y * MapSize.z;
+			stamps.assign(tilesCount, 0);
+			values.assign(tilesCount, T());
+			generation = 1;
+		}
+		else
+			clear();
+	}
+
+	void clear()
+	{
+		if (++generation == 0) //wrapped around, old stamps could be taken for valid
+		{
+			std::fill(stamps.begin(), stamps.end(), 0);
+			generation = 1;
+		}
+	}
+
+	bool contains(const int3 & tile) const
+	{
+		return stamps[index(tile)] == generation;
+	}
+
+	/// returns nullptr if there is no value for given tile
+	const T * find(const int3 & tile) const
+	{
+		size_t i = index(tile);
+		return stamps[i] == generation ? &values[i] : nullptr;
+	}
+
+	/// value is default-constructed if it is not present yet
+	T & operator[](const int3 & tile)
+	{
+		size_t i = index(tile);
+		if (stamps[i] != generation)
+		{
+			stamps[i] = generation;
+			values[i] = T();
+		}
+		return values[i];
+	}
+
+private:
+	int3 mapSize;
+	ui32 generation;
+	std::vector<ui32> stamps; //value of tile is valid only if its stamp matches current generation
+	std::vector<T> values;
+
+	size_t index(const int3 & tile) const
+	{
+		assert(tile.x >= 0 && tile.y >= 0 && tile.z >= 0 && tile.x < mapSize.x && tile.y < mapSize.y && tile.z < mapSize.z);
+		return (static_cast<size_t>(tile.z) * mapSize.y + tile.y) * mapSize.x + tile.x;
+	}
+};
@@ -15,6 +15,7 @@
 #include "../mapping/CMap.h"
 
 #include "CZoneGraphGenerator.h"
+#include "../CThreadHelper.h"
 
 class CRandomGenerator;
 
@@ -446,11 +447,82 @@ d = 0.01 * dx^3 - 0.1618 * dx^2 + 1 * dx + ...
     0.01618 * dy^3 + 0.1 * dy^2 + 0.168 * dy;
 */
 
-	float dx = abs(A.x - B.x) * scaleX;
-	float dy = abs(A.y - B.y) * scaleY;
+	return metricX(A.x - B.x) + metricY(A.y - B.y);
+}
+
+double CZonePlacer::metricX(int x) const
+{
+	float dx = abs(x) * scaleX;
 
 	//Horner scheme
-	return dx * (1 + dx * (0.1 + dx * 0.01)) + dy * (1.618 + dy * (-0.1618 + dy * 0.01618));
+	return dx * (1 + dx * (0.1 + dx * 0.01));
+}
+
+double CZonePlacer::metricY(int y) const
+{
+	float dy = abs(y) * scaleY;
+
+	return dy * (1.618 + dy * (-0.1618 + dy * 0.01618));
+}
+
+namespace
+{
+	/// For every tile finds index of zone with lowest distance divided by zone size, the same one boost::min_element would pick.
+	/// distance(zoneIndex, x, y) is called only for zones on the level of the tile. Rows are processed in parallel
+	template<typename Distance>
+	std::vector<size_t> findClosestZones(const std::vector<std::shared_ptr<CRmgTemplateZone>> & zones, int width, int height, int levels, Distance distance)
+	{
+		std::vector<size_t> result(width * height * levels);
+		std::vector<int> zoneLevels;
+		std::vector<int> zoneSizes;
+
+		for (auto zone : zones)
+		{
+			zoneLevels.push_back(zone->getPos().z);
+			zoneSizes.push_back(zone->getSize());
+		}
+
+		std::vector<Task> tasks;
+		for (int k = 0; k < levels; k++)
+		{
+			for (int j = 0; j < height; j++)
+			{
+				tasks.push_back([&, j, k]()
+				{
+					for (int i = 0; i < width; i++)
+					{
+						size_t closest = 0;
+						float closestDistance = 0;
+						for (size_t zone = 0; zone < zoneSizes.size(); zone++)
+						{
+							float zoneDistance = std::numeric_limits<float>::max();
+							if (zoneLevels[zone] == k)
+								zoneDistance = distance(zone, i, j);
+
+							//bigger zones have smaller distance
+							zoneDistance = zoneDistance / zoneSizes[zone];
+							if (zone == 0 || zoneDistance < closestDistance)
+							{
+								closest = zone;
+								closestDistance = zoneDistance;
+							}
+						}
+						result[(k * height + j) * width + i] = closest;
+					}
+				});
+			}
+		}
+
+		uint32_t threadCount = boost::thread::hardware_concurrency();
+
+		vstd::amin(threadCount, tasks.size());
+		vstd::amax(threadCount, 1);
+
+		CThreadHelper threadHelper(&tasks, threadCount);
+		threadHelper.run();
+
+		return result;
+	}
 }
 
 void CZonePlacer::assignZones(const CMapGenOptions * mapGenOptions)
@@ -464,24 +536,16 @@ void CZonePlacer::assignZones(const CMapGenOptions * mapGenOptions)
 	scaleX = 72.f / width;
 	scaleY = 72.f / height;
 
-	auto zones = gen->getZones();
-
-	typedef std::pair<std::shared_ptr<CRmgTemplateZone>, float> Dpair;
-	std::vector <Dpair> distances;
-	distances.reserve(zones.size());
+	std::vector<std::shared_ptr<CRmgTemplateZone>> zones;
+	for (auto zone : gen->getZones())
+		zones.push_back(zone.second);
 
 	//now place zones correctly and assign tiles to each zone
 
-	auto compareByDistance = [](const Dpair & lhs, const Dpair & rhs) -> bool
-	{
-		//bigger zones have smaller distance
-		return lhs.second / lhs.first->getSize() < rhs.second / rhs.first->getSize();
-	};
-
 	auto moveZoneToCenterOfMass = [](std::shared_ptr<CRmgTemplateZone> zone) -> void
 	{
 		int3 total(0, 0, 0);
-		auto tiles = zone->getTileInfo();
+		const auto & tiles = zone->getTileInfo();
 		for (auto tile : tiles)
 		{
 			total += tile;
@@ -498,50 +562,56 @@ void CZonePlacer::assignZones(const CMapGenOptions * mapGenOptions)
 	2. find current center of mass for each zone. Move zone to that center to balance zones sizes
 	*/
 
-	for (int i = 0; i<width; i++)
+	std::vector<int3> zonePositions;
+	for (auto zone : zones)
+		zonePositions.push_back(zone->getPos());
+
+	auto closestZones = findClosestZones(zones, width, height, levels, [&zonePositions](size_t zone, int x, int y) -> float
+	{
+		return int3(x, y, zonePositions[zone].z).dist2dSQ(zonePositions[zone]);
+	});
+
+	for (int k = 0; k < levels; k++)
 	{
-		for (int j = 0; j<height; j++)
+		for (int j = 0; j < height; j++)
 		{
-			for (int k = 0; k < levels; k++)
-			{
-				distances.clear();
-				int3 pos(i, j, k);
-				for (auto zone : zones)
-				{
-					if (zone.second->getPos().z == k)
-						distances.push_back(std::make_pair(zone.second, pos.dist2dSQ(zone.second->getPos())));
-					else
-						distances.push_back(std::make_pair(zone.second, std::numeric_limits<float>::max()));
-				}
-				boost::min_element(distances, compareByDistance)->first->addTile(pos); //closest tile belongs to zone
-			}
+			for (int i = 0; i < width; i++)
+				zones[closestZones[(k * height + j) * width + i]]->addTile(int3(i, j, k)); //closest tile belongs to zone
 		}
 	}
 
 	for (auto zone : zones)
-		moveZoneToCenterOfMass(zone.second);
+		moveZoneToCenterOfMass(zone);
 
 	//assign actual tiles to each zone using nonlinear norm for fine edges
 
 	for (auto zone : zones)
-		zone.second->clearTiles(); //now populate them again
+		zone->clearTiles(); //now populate them again
+
+	//both axes contribute to the metric independently, so their terms are computed once per zone and column / row
+	std::vector<std::vector<double>> columnTerms(zones.size()), rowTerms(zones.size());
+	for (size_t zone = 0; zone < zones.size(); zone++)
+	{
+		int3 zonePos = zones[zone]->getPos();
+		for (int i = 0; i < width; i++)
+			columnTerms[zone].push_back(metricX(i - zonePos.x));
+		for (int j = 0; j < height; j++)
+			rowTerms[zone].push_back(metricY(j - zonePos.y));
+	}
+
+	closestZones = findClosestZones(zones, width, height, levels, [&columnTerms, &rowTerms](size_t zone, int x, int y) -> float
+	{
+		return columnTerms[zone][x] + rowTerms[zone][y];
+	});
 
-	for (int i=0; i<width; i++)
+	for (int k = 0; k < levels; k++)
 	{
-		for(int j=0; j<height; j++)
+		for (int j = 0; j < height; j++)
 		{
-			for (int k = 0; k < levels; k++)
+			for (int i = 0; i < width; i++)
 			{
-				distances.clear();
 				int3 pos(i, j, k);
-				for (auto zone : zones)
-				{
-					if (zone.second->getPos().z == k)
-						distances.push_back (std::make_pair(zone.second, metric(pos, zone.second->getPos())));
-					else
-						distances.push_back (std::make_pair(zone.second, std::numeric_limits<float>::max()));
-				}
-				auto zone = boost::min_element(distances, compareByDistance)->first; //closest tile belongs to zone
+				auto zone = zones[closestZones[(k * height + j) * width + i]]; //closest tile belongs to zone
 				zone->addTile(pos);
 				gen->setZoneID(pos, zone->getId());
 			}
@@ -550,18 +620,18 @@ void CZonePlacer::assignZones(const CMapGenOptions * mapGenOptions)
 	//set position (town position) to center of mass of irregular zone
 	for (auto zone : zones)
 	{
-		moveZoneToCenterOfMass(zone.second);
+		moveZoneToCenterOfMass(zone);
 
 		//TODO: similiar for islands
 		#define	CREATE_FULL_UNDERGROUND true //consider linking this with water amount
-		if (zone.second->getPos().z)
+		if (zone->getPos().z)
 		{
 			if (!CREATE_FULL_UNDERGROUND)
-				zone.second->discardDistantTiles(zone.second->getSize() + 1);
+				zone->discardDistantTiles(zone->getSize() + 1);
 
 			//make sure that terrain inside zone is not a rock
 			//FIXME: reorder actions?
-			zone.second->paintZoneTerrain (ETerrainType::SUBTERRANEAN);
+			zone->paintZoneTerrain (ETerrainType::SUBTERRANEAN);
 		}
 	}
 	logGlobal->info("Finished zone colouring");
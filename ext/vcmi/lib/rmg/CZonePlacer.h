@@ -31,6 +31,8 @@ public:
 	explicit CZonePlacer(CMapGenerator * gen);
 	int3 cords (const float3 f) const;
 	float metric (const int3 &a, const int3 &b) const;
+	double metricX(int x) const; //horizontal part of metric
+	double metricY(int y) const; //vertical part of metric
 	float getDistance(float distance) const; //additional scaling without 0 divison
 	~CZonePlacer();
 
@@ -10,6 +10,8 @@
 #include "StdInc.h"
 #include "BinaryDeserializer.h"
 #include "../filesystem/FileStream.h"
+#include "../filesystem/CCompressedStream.h"
+#include "../filesystem/CFileInputStream.h"
 
 #include "../registerTypes/RegisterTypes.h"
 
@@ -28,6 +30,15 @@ CLoadFile::~CLoadFile()
 
 int CLoadFile::read(void * data, unsigned size)
 {
+	if(compressedStream)
+	{
+		si64 start = compressedStream->tell();
+		compressedStream->read((ui8*)data, size);
+		if(compressedStream->tell() - start != size)
+			THROW_FORMAT("Error: unexpected end of compressed file %s!", fName);
+		return size;
+	}
+
 	sfile->read((char*)data,size);
 	return size;
 }
@@ -49,7 +60,8 @@ void CLoadFile::openNextFile(const boost::filesystem::path & fname, int minimalV
 		//we can read
 		char buffer[4];
 		sfile->read(buffer, 4);
-		if(std::memcmp(buffer,"VCMI",4))
+		bool compressed = !std::memcmp(buffer,"VCMZ",4);
+		if(std::memcmp(buffer,"VCMI",4) && !compressed)
 			THROW_FORMAT("Error: not a VCMI file(%s)!", fName);
 
 		serializer & serializer.fileVersion;
@@ -72,6 +84,10 @@ void CLoadFile::openNextFile(const boost::filesystem::path & fname, int minimalV
 			else
 				THROW_FORMAT("Error: too new file format (%s)!", fName);
 		}
+
+		compressedStream.reset();
+		if(compressed)
+			compressedStream = make_unique<CCompressedStream>(make_unique<CFileInputStream>(fname, sfile->tellg()), false);
 	}
 	catch(...)
 	{
@@ -89,6 +105,7 @@ void CLoadFile::reportState(vstd::CLoggerBase * out)
 
 void CLoadFile::clear()
 {
+	compressedStream = nullptr;
 	sfile = nullptr;
 	fName.clear();
 	serializer.fileVersion = 0;
@@ -17,6 +17,7 @@
 
 class CStackInstance;
 class FileStream;
+class CInputStream;
 
 class DLL_LINKAGE CLoaderBase
 {
@@ -112,6 +113,37 @@ class DLL_LINKAGE BinaryDeserializer : public CLoaderBase
 		}
 	};
 
+	template <typename T>
+	void loadBulk(T * data, ui32 count)
+	{
+		if(!count)
+			return;
+
+		this->read(data, count * sizeof(T));
+
+		if(reverseEndianess)
+		{
+			for(ui32 i = 0; i < count; i++)
+			{
+				char * dataPtr = (char*)(data + i);
+				std::reverse(dataPtr, dataPtr + sizeof(T));
+			}
+		}
+	}
+
+	template <typename T, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void loadElements(T * data, size_t count)
+	{
+		loadBulk(data, count);
+	}
+
+	template <typename T, typename std::enable_if < !is_bulk_serializeable<T>::value, int  >::type = 0>
+	void loadElements(T * data, size_t count)
+	{
+		for(size_t i = 0; i < count; i++)
+			load(data[i]);
+	}
+
 	STRONG_INLINE ui32 readAndCheckLength()
 	{
 		ui32 length;
@@ -238,7 +270,7 @@ public:
 		range::copy(convData, data.begin());
 	}
 
-	template <typename T, typename std::enable_if < !std::is_same<T, bool >::value, int  >::type = 0>
+	template <typename T, typename std::enable_if < !std::is_same<T, bool >::value && !is_bulk_serializeable<T>::value, int  >::type = 0>
 	void load(std::vector<T> &data)
 	{
 		ui32 length = readAndCheckLength();
@@ -247,6 +279,14 @@ public:
 			load( data[i]);
 	}
 
+	template <typename T, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void load(std::vector<T> &data)
+	{
+		ui32 length = readAndCheckLength();
+		data.resize(length);
+		loadBulk(data.data(), length);
+	}
+
 	template < typename T, typename std::enable_if < std::is_pointer<T>::value, int  >::type = 0 >
 	void load(T &data)
 	{
@@ -396,12 +436,33 @@ public:
 		load( internalPtr );
 		data.reset(internalPtr);
 	}
-	template <typename T, size_t N>
+	template <typename T, size_t N, typename std::enable_if < !is_bulk_serializeable<T>::value, int  >::type = 0>
 	void load(std::array<T, N> &data)
 	{
 		for(ui32 i = 0; i < N; i++)
 			load( data[i] );
 	}
+	template <typename T, size_t N, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void load(std::array<T, N> &data)
+	{
+		loadBulk(data.data(), N);
+	}
+	template <typename T, size_t N>
+	void load(boost::multi_array<T, N> &data)
+	{
+		boost::array<ui32, N> shape;
+		ui64 elements = 1;
+		for(size_t i = 0; i < N; i++)
+		{
+			load(shape[i]);
+			elements *= shape[i];
+			//same limits as saving side, no valid stream can contain bigger array
+			if(elements > std::numeric_limits<ui32>::max() || elements > std::numeric_limits<unsigned>::max() / sizeof(T))
+				throw std::runtime_error(boost::str(boost::format("Loaded array is too big: %d elements") % elements));
+		}
+		data.resize(shape);
+		loadElements(data.data(), data.num_elements());
+	}
 	template <typename T>
 	void load(std::set<T> &data)
 	{
@@ -512,6 +573,7 @@ public:
 	}
 };
 
+/// Loads objects from file saved by CSaveFile, decompressing it if needed
 class DLL_LINKAGE CLoadFile : public IBinaryReader
 {
 public:
@@ -519,6 +581,7 @@ public:
 
 	std::string fName;
 	std::unique_ptr<FileStream> sfile;
+	std::unique_ptr<CInputStream> compressedStream; //if file is compressed, data after version are read from here
 
 	CLoadFile(const boost::filesystem::path & fname, int minimalVersion = SERIALIZATION_VERSION); //throws!
 	~CLoadFile();
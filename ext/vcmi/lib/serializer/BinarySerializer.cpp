@@ -10,13 +10,17 @@
 #include "StdInc.h"
 #include "BinarySerializer.h"
 #include "../filesystem/FileStream.h"
+#include "../CConfigHandler.h"
+#include "../ScopeGuard.h"
+
+#include <zlib.h>
 
 #include "../registerTypes/RegisterTypes.h"
 
 extern template void registerTypes<BinarySerializer>(BinarySerializer & s);
 
 CSaveFile::CSaveFile(const boost::filesystem::path &fname)
-	: serializer(this)
+	: deflateState(nullptr), serializer(this)
 {
 	registerTypes(serializer);
 	openNextFile(fname);
@@ -24,16 +28,89 @@ CSaveFile::CSaveFile(const boost::filesystem::path &fname)
 
 CSaveFile::~CSaveFile()
 {
+	try
+	{
+		finishCompression();
+	}
+	catch(std::exception & e)
+	{
+		logGlobal->error("Failed to finish writing %s: %s", fName.string(), e.what());
+	}
 }
 
 int CSaveFile::write(const void * data, unsigned size)
 {
-	sfile->write((char *)data,size);
+	if(!deflateState)
+	{
+		sfile->write((char *)data,size);
+		return size;
+	}
+
+	deflateState->next_in = (Bytef *)data;
+	deflateState->avail_in = size;
+	writeCompressed(Z_NO_FLUSH);
 	return size;
 }
 
+void CSaveFile::startCompression(int level)
+{
+	deflateState = new z_stream();
+	deflateState->zalloc = Z_NULL;
+	deflateState->zfree = Z_NULL;
+	deflateState->opaque = Z_NULL;
+
+	if(deflateInit(deflateState, level) != Z_OK)
+	{
+		delete deflateState;
+		deflateState = nullptr;
+		throw std::runtime_error("Failed to initialize deflate!");
+	}
+
+	compressedBuffer.resize(65536);
+}
+
+void CSaveFile::writeCompressed(int flush)
+{
+	// deflate until all input is consumed (and for Z_FINISH until stream is complete)
+	int ret;
+	do
+	{
+		deflateState->next_out = compressedBuffer.data();
+		deflateState->avail_out = compressedBuffer.size();
+
+		ret = deflate(deflateState, flush);
+		if(ret == Z_STREAM_ERROR)
+			throw std::runtime_error("Failed to compress save file!");
+
+		sfile->write((char *)compressedBuffer.data(), compressedBuffer.size() - deflateState->avail_out);
+	}
+	while(deflateState->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+}
+
+void CSaveFile::finishCompression()
+{
+	if(!deflateState)
+		return;
+
+	auto onExit = vstd::makeScopeGuard([&]()
+	{
+		deflateEnd(deflateState);
+		delete deflateState;
+		deflateState = nullptr;
+	});
+
+	if(sfile)
+	{
+		deflateState->next_in = Z_NULL;
+		deflateState->avail_in = 0;
+		writeCompressed(Z_FINISH);
+	}
+}
+
 void CSaveFile::openNextFile(const boost::filesystem::path &fname)
 {
+	finishCompression();
+
 	fName = fname;
 	try
 	{
@@ -43,8 +120,14 @@ void CSaveFile::openNextFile(const boost::filesystem::path &fname)
 		if(!(*sfile))
 			THROW_FORMAT("Error: cannot open to write %s!", fname);
 
-		sfile->write("VCMI",4); //write magic identifier
+		const JsonNode & compression = settings["server"]["compression"];
+		bool compressed = compression["saves"].Bool();
+
+		sfile->write(compressed ? "VCMZ" : "VCMI", 4); //write magic identifier, VCMZ marks compressed file
 		serializer & SERIALIZATION_VERSION; //write format version
+
+		if(compressed)
+			startCompression(compression["level"].Integer());
 	}
 	catch(...)
 	{
@@ -65,6 +148,7 @@ void CSaveFile::reportState(vstd::CLoggerBase * out)
 
 void CSaveFile::clear()
 {
+	finishCompression();
 	fName.clear();
 	sfile = nullptr;
 }
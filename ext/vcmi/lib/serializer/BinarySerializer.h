@@ -13,6 +13,7 @@
 #include "../mapObjects/CArmedInstance.h"
 
 class FileStream;
+struct z_stream_s;
 
 class DLL_LINKAGE CSaverBase
 {
@@ -108,6 +109,37 @@ class DLL_LINKAGE BinarySerializer : public CSaverBase
 
 	CApplier<CBasicPointerSaver> applier;
 
+	static ui32 checkedLength(size_t length)
+	{
+		if(length > std::numeric_limits<ui32>::max())
+			throw std::runtime_error(boost::str(boost::format("Saved container is too big: %d elements") % length));
+		return length;
+	}
+
+	template <typename T>
+	void saveBulk(const T * data, ui32 count)
+	{
+		if(count > std::numeric_limits<unsigned>::max() / sizeof(T))
+			throw std::runtime_error(boost::str(boost::format("Saved array is too big: %d elements") % count));
+
+		// serialized form of primitive is its memory, so whole block can be dumped at once
+		if(count)
+			this->write(data, count * sizeof(T));
+	}
+
+	template <typename T, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void saveElements(const T * data, size_t count)
+	{
+		saveBulk(data, checkedLength(count));
+	}
+
+	template <typename T, typename std::enable_if < !is_bulk_serializeable<T>::value, int  >::type = 0>
+	void saveElements(const T * data, size_t count)
+	{
+		for(size_t i = 0; i < count; i++)
+			save(data[i]);
+	}
+
 public:
 	std::map<const void*, ui32> savedPointers;
 
@@ -250,7 +282,7 @@ public:
 		T *internalPtr = data.get();
 		save(internalPtr);
 	}
-	template <typename T, typename std::enable_if < !std::is_same<T, bool >::value, int  >::type = 0>
+	template <typename T, typename std::enable_if < !std::is_same<T, bool >::value && !is_bulk_serializeable<T>::value, int  >::type = 0>
 	void save(const std::vector<T> &data)
 	{
 		ui32 length = data.size();
@@ -258,12 +290,31 @@ public:
 		for(ui32 i=0;i<length;i++)
 			save(data[i]);
 	}
-	template <typename T, size_t N>
+	template <typename T, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void save(const std::vector<T> &data)
+	{
+		ui32 length = checkedLength(data.size());
+		*this & length;
+		saveBulk(data.data(), length);
+	}
+	template <typename T, size_t N, typename std::enable_if < !is_bulk_serializeable<T>::value, int  >::type = 0>
 	void save(const std::array<T, N> &data)
 	{
 		for(ui32 i=0; i < N; i++)
 			save(data[i]);
 	}
+	template <typename T, size_t N, typename std::enable_if < is_bulk_serializeable<T>::value, int  >::type = 0>
+	void save(const std::array<T, N> &data)
+	{
+		saveBulk(data.data(), N);
+	}
+	template <typename T, size_t N>
+	void save(const boost::multi_array<T, N> &data)
+	{
+		for(size_t i = 0; i < N; i++)
+			save(checkedLength(data.shape()[i]));
+		saveElements(data.data(), data.num_elements());
+	}
 	template <typename T>
 	void save(const std::set<T> &data)
 	{
@@ -346,8 +397,15 @@ public:
 	}
 };
 
+/// Saves objects into file. If enabled in settings, everything after format version is compressed with zlib
 class DLL_LINKAGE CSaveFile : public IBinaryWriter
 {
+	z_stream_s * deflateState; //nullptr if file is not compressed
+	std::vector<ui8> compressedBuffer;
+
+	void startCompression(int level);
+	void finishCompression();
+	void writeCompressed(int flush);
 public:
 	BinarySerializer serializer;
 
@@ -12,7 +12,7 @@
 #include "../ConstTransitivePtr.h"
 #include "../GameConstants.h"
 
-const ui32 SERIALIZATION_VERSION = 790;
+const ui32 SERIALIZATION_VERSION = 791;
 const ui32 MINIMAL_SERIALIZATION_VERSION = 753;
 const std::string SAVEGAME_MAGIC = "VCMISVG";
 
@@ -145,6 +145,14 @@ struct is_serializeable
 	static const bool value = sizeof(Yes) == sizeof(is_serializeable::test((typename std::remove_reference<typename std::remove_cv<T>::type>::type*)0));
 };
 
+/// Helper to detect types whose in-memory representation matches serialized one, so containers
+/// of them can be copied as a single memory block
+template<class T>
+struct is_bulk_serializeable
+{
+	static const bool value = std::is_fundamental<T>::value && !std::is_same<T, bool>::value;
+};
+
 template <typename T> //metafunction returning CGObjectInstance if T is its derivate or T elsewise
 struct VectorizedTypeFor
 {
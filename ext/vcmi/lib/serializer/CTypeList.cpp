@@ -17,8 +17,10 @@ extern template void registerTypes<CTypeList>(CTypeList & s);
 CTypeList typeList;
 
 CTypeList::CTypeList()
+	: frozen(false)
 {
 	registerTypes(*this);
+	freeze();
 }
 
 CTypeList::TypeInfoPtr CTypeList::registerType(const std::type_info *type)
@@ -45,26 +47,37 @@ ui16 CTypeList::getTypeID(const std::type_info *type, bool throws) const
 	return descriptor->typeID;
 }
 
-std::vector<CTypeList::TypeInfoPtr> CTypeList::castSequence(TypeInfoPtr from, TypeInfoPtr to) const
+bool CTypeList::isRegistered(const std::type_info *base, const std::type_info *derived) const
 {
-	if(!strcmp(from->name, to->name))
-		return std::vector<CTypeList::TypeInfoPtr>();
+	auto bti = getTypeDescriptor(base, false);
+	auto dti = getTypeDescriptor(derived, false);
 
-	// Perform a simple BFS in the class hierarchy.
+	return bti && dti && casters.count(std::make_pair(bti, dti));
+}
+
+ui32 CTypeList::castPathKey(ui16 from, ui16 to)
+{
+	return (static_cast<ui32>(from) << 16) | to;
+}
 
-	auto BFS = [&](bool upcast)
+void CTypeList::freeze()
+{
+	// BFS from each type up through its parents gives the shortest upcast path to every ancestor,
+	// downcast path is the same path walked in reverse
+	for(auto & typeInfo : typeInfos)
 	{
+		auto derived = typeInfo.second;
 		std::map<TypeInfoPtr, TypeInfoPtr> previous;
 		std::queue<TypeInfoPtr> q;
-		q.push(to);
+		q.push(derived);
 		while(q.size())
 		{
 			auto typeNode = q.front();
 			q.pop();
-			for(auto & weakNode : (upcast ? typeNode->parents : typeNode->children) )
+			for(auto & weakNode : typeNode->parents)
 			{
 				auto nodeBase = weakNode.lock();
-				if(!previous.count(nodeBase))
+				if(nodeBase != derived && !previous.count(nodeBase))
 				{
 					previous[nodeBase] = typeNode;
 					q.push(nodeBase);
@@ -72,41 +85,44 @@ std::vector<CTypeList::TypeInfoPtr> CTypeList::castSequence(TypeInfoPtr from, Ty
 			}
 		}
 
-		std::vector<TypeInfoPtr> ret;
-
-		if(!previous.count(from))
-			return ret;
-
-		ret.push_back(from);
-		TypeInfoPtr ptr = from;
-		do
+		for(auto & ancestorInfo : previous)
 		{
-			ptr = previous.at(ptr);
-			ret.push_back(ptr);
-		} while(ptr != to);
-
-		return ret;
-	};
+			auto base = ancestorInfo.first;
+			TCastPath upcast, downcast;
 
-	// Try looking both up and down.
-	auto ret = BFS(true);
-	if(ret.empty())
-		ret = BFS(false);
+			for(auto ptr = base; ptr != derived; ptr = previous.at(ptr))
+			{
+				auto child = previous.at(ptr);
+				upcast.push_back(casters.at(std::make_pair(child, ptr)).get());
+				downcast.push_back(casters.at(std::make_pair(ptr, child)).get());
+			}
 
-	if(ret.empty())
-		THROW_FORMAT("Cannot find relation between types %s and %s. Were they (and all classes between them) properly registered?", from->name % to->name);
+			std::reverse(upcast.begin(), upcast.end());
+			castPaths[castPathKey(derived->typeID, base->typeID)] = upcast;
+			castPaths[castPathKey(base->typeID, derived->typeID)] = downcast;
+		}
+	}
 
-	return ret;
+	frozen = true;
 }
 
-std::vector<CTypeList::TypeInfoPtr> CTypeList::castSequence(const std::type_info *from, const std::type_info *to) const
+const CTypeList::TCastPath & CTypeList::getCastPath(const std::type_info *from, const std::type_info *to) const
 {
+	static const TCastPath noCast;
+
 	//This additional if is needed because getTypeDescriptor might fail if type is not registered
 	// (and if casting is not needed, then registereing should no  be required)
 	if(!strcmp(from->name(), to->name()))
-		return std::vector<CTypeList::TypeInfoPtr>();
+		return noCast;
+
+	auto fromInfo = getTypeDescriptor(from);
+	auto toInfo = getTypeDescriptor(to);
+
+	auto path = castPaths.find(castPathKey(fromInfo->typeID, toInfo->typeID));
+	if(path == castPaths.end())
+		THROW_FORMAT("Cannot find relation between types %s and %s. Were they (and all classes between them) properly registered?", fromInfo->name % toInfo->name);
 
-	return castSequence(getTypeDescriptor(from), getTypeDescriptor(to));
+	return path->second;
 }
 
 CTypeList::TypeInfoPtr CTypeList::getTypeDescriptor(const std::type_info *type, bool throws) const
@@ -58,6 +58,8 @@ struct PointerCaster : IPointerCaster
 
 /// Class that implements basic reflection-like mechanisms
 /// For every type registered via registerType() generates inheritance tree
+/// Once all types are registered, list is frozen and cast paths between related types are precomputed,
+/// so casting can be done from any thread without locking
 /// Rarely used directly - usually used as part of CApplier
 class DLL_LINKAGE CTypeList: public boost::noncopyable
 {
@@ -71,38 +73,29 @@ class DLL_LINKAGE CTypeList: public boost::noncopyable
 		const char *name;
 		std::vector<WeakTypeInfoPtr> children, parents;
 	};
-	typedef boost::shared_mutex TMutex;
-	typedef boost::unique_lock<TMutex> TUniqueLock;
-	typedef boost::shared_lock<TMutex> TSharedLock;
+	typedef std::vector<const IPointerCaster *> TCastPath;
 private:
-	mutable TMutex mx;
+	bool frozen;
 
 	std::map<const std::type_info *, TypeInfoPtr, TypeComparer> typeInfos;
 	std::map<std::pair<TypeInfoPtr, TypeInfoPtr>, std::unique_ptr<const IPointerCaster>> casters; //for each pair <Base, Der> we provide a caster (each registered relations creates a single entry here)
+	std::unordered_map<ui32, TCastPath> castPaths; //casters to apply for each pair of related types, filled by freeze()
 
-	/// Returns sequence of types starting from "from" and ending on "to". Every next type is derived from the previous.
+	static ui32 castPathKey(ui16 from, ui16 to);
+
+	/// Precomputes cast paths between every type and all its ancestors. No types can be registered afterwards.
+	void freeze();
+
+	/// Returns casters converting "from" to "to", empty if types are the same.
 	/// Throws if there is no link registered.
-	std::vector<TypeInfoPtr> castSequence(TypeInfoPtr from, TypeInfoPtr to) const;
-	std::vector<TypeInfoPtr> castSequence(const std::type_info *from, const std::type_info *to) const;
+	const TCastPath & getCastPath(const std::type_info *from, const std::type_info *to) const;
 
 	template<boost::any(IPointerCaster::*CastingFunction)(const boost::any &) const>
 	boost::any castHelper(boost::any inputPtr, const std::type_info *fromArg, const std::type_info *toArg) const
 	{
-		TSharedLock lock(mx);
-		auto typesSequence = castSequence(fromArg, toArg);
-
 		boost::any ptr = inputPtr;
-		for(int i = 0; i < static_cast<int>(typesSequence.size()) - 1; i++)
-		{
-			auto &from = typesSequence[i];
-			auto &to = typesSequence[i + 1];
-			auto castingPair = std::make_pair(from, to);
-			if(!casters.count(castingPair))
-				THROW_FORMAT("Cannot find caster for conversion %s -> %s which is needed to cast %s -> %s", from->name % to->name % fromArg->name() % toArg->name());
-
-			auto &caster = casters.at(castingPair);
-			ptr = (*caster.*CastingFunction)(ptr); //Why does unique_ptr not have operator->* ..?
-		}
+		for(const IPointerCaster * caster : getCastPath(fromArg, toArg))
+			ptr = (caster->*CastingFunction)(ptr);
 
 		return ptr;
 	}
@@ -123,12 +116,20 @@ public:
 	template <typename Base, typename Derived>
 	void registerType(const Base * b = nullptr, const Derived * d = nullptr)
 	{
-		TUniqueLock lock(mx);
 		static_assert(std::is_base_of<Base, Derived>::value, "First registerType template parameter needs to ba a base class of the second one.");
 		static_assert(std::has_virtual_destructor<Base>::value, "Base class needs to have a virtual destructor.");
 		static_assert(!std::is_same<Base, Derived>::value, "Parameters of registerTypes should be two different types.");
 		auto bt = getTypeInfo(b);
 		auto dt = getTypeInfo(d); //obtain std::type_info
+
+		if(frozen)
+		{
+			// appliers register the same relations again, that's fine as long as nothing new is added
+			if(!isRegistered(bt, dt))
+				THROW_FORMAT("Cannot register relation %s -> %s, type list is already frozen", bt->name() % dt->name());
+			return;
+		}
+
 		auto bti = registerType(bt);
 		auto dti = registerType(dt); //obtain our TypeDescriptor
 
@@ -140,6 +141,7 @@ public:
 	}
 
 	ui16 getTypeID(const std::type_info *type, bool throws = false) const;
+	bool isRegistered(const std::type_info *base, const std::type_info *derived) const;
 
 	template <typename T>
 	ui16 getTypeID(const T * t = nullptr, bool throws = false) const
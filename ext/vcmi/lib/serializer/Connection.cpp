@@ -13,8 +13,10 @@
 #include "../registerTypes/RegisterTypes.h"
 #include "../mapping/CMap.h"
 #include "../CGameState.h"
+#include "../CConfigHandler.h"
 
 #include <boost/asio.hpp>
+#include <zlib.h>
 
 using namespace boost;
 using namespace boost::asio::ip;
@@ -29,6 +31,61 @@ using namespace boost::asio::ip;
 #define LIL_ENDIAN
 #endif
 
+namespace
+{
+	const size_t FRAME_HEADER_SIZE = 4;
+	const ui32 COMPRESSED_FRAME_FLAG = 0x80000000;
+	const int CLOSE_TIMEOUT_SECONDS = 5; //how long closed connection may keep sending queued frames
+
+	// frame headers are always little endian - first one is sent before endianness of the other side is known
+	void writeLittleEndian(ui8 * dest, ui32 value)
+	{
+		dest[0] = ui8(value);
+		dest[1] = ui8(value >> 8);
+		dest[2] = ui8(value >> 16);
+		dest[3] = ui8(value >> 24);
+	}
+
+	ui32 readLittleEndian(const ui8 * src)
+	{
+		return src[0] | (src[1] << 8) | (src[2] << 16) | (ui32(src[3]) << 24);
+	}
+}
+
+CSerializedFrame::CSerializedFrame(std::shared_ptr<const std::vector<ui8>> plain)
+	: plain(plain), compressedLevel(0)
+{
+}
+
+std::shared_ptr<const std::vector<ui8>> CSerializedFrame::getFrame(int compressionLevel, ui32 compressionThreshold)
+{
+	ui32 payloadSize = plain->size() - FRAME_HEADER_SIZE;
+
+	if(compressionLevel <= 0 || payloadSize < compressionThreshold)
+		return plain;
+
+	if(compressedLevel != compressionLevel)
+	{
+		compressedLevel = compressionLevel;
+		compressed.reset();
+
+		// compressed payload is prefixed with its original size
+		uLongf compressedSize = compressBound(payloadSize);
+		auto frame = std::make_shared<std::vector<ui8>>(FRAME_HEADER_SIZE + 4 + compressedSize);
+
+		int ret = compress2(frame->data() + FRAME_HEADER_SIZE + 4, &compressedSize, plain->data() + FRAME_HEADER_SIZE, payloadSize, compressionLevel);
+		if(ret == Z_OK && compressedSize + 4 < payloadSize)
+		{
+			frame->resize(FRAME_HEADER_SIZE + 4 + compressedSize);
+			writeLittleEndian(frame->data(), (compressedSize + 4) | COMPRESSED_FRAME_FLAG);
+			writeLittleEndian(frame->data() + FRAME_HEADER_SIZE, payloadSize);
+			compressed = frame;
+		}
+	}
+
+	return compressed ? compressed : plain;
+}
+
 
 void CConnection::init()
 {
@@ -46,10 +103,19 @@ void CConnection::init()
 	myEndianess = false;
 #endif
 	connected = true;
+
+	const JsonNode & compression = settings["server"]["compression"];
+	compressionLevel = compression["network"].Bool() ? compression["level"].Integer() : 0;
+	compressionThreshold = compression["threshold"].Integer();
+	contactAcceptsCompression = false;
+	writeBuffer.assign(FRAME_HEADER_SIZE, 0);
+
 	std::string pom;
+	bool acceptsCompression = compression["network"].Bool();
 	//we got connection
-	oser & std::string("Aiya!\n") & name & uuid & myEndianess; //identify ourselves
-	iser & pom & pom & contactUuid & contactEndianess;
+	oser & std::string("Aiya!\n") & name & uuid & myEndianess & acceptsCompression; //identify ourselves
+	flushFrame();
+	iser & pom & pom & contactUuid & contactEndianess & contactAcceptsCompression;
 	logNetwork->info("Established connection with %s. UUID: %s", pom, contactUuid);
 	mutexRead = std::make_shared<boost::mutex>();
 	mutexWrite = std::make_shared<boost::mutex>();
@@ -58,7 +124,7 @@ void CConnection::init()
 }
 
 CConnection::CConnection(std::string host, ui16 port, std::string Name, std::string UUID)
-	: io_service(std::make_shared<asio::io_service>()), iser(this), oser(this), name(Name), uuid(UUID), connectionID(0)
+	: io_service(std::make_shared<asio::io_service>()), iser(this), oser(this), name(Name), uuid(UUID), connectionID(0), readPos(0), asyncSending(false), writeInProgress(false), closeAfterSending(false), bytesPending(0), timeBlocked(0)
 {
 	int i;
 	boost::system::error_code error = asio::error::host_not_found;
@@ -111,12 +177,12 @@ connerror1:
 	throw std::runtime_error("Can't establish connection :(");
 }
 CConnection::CConnection(std::shared_ptr<TSocket> Socket, std::string Name, std::string UUID)
-	: iser(this), oser(this), socket(Socket), name(Name), uuid(UUID), connectionID(0)
+	: iser(this), oser(this), socket(Socket), name(Name), uuid(UUID), connectionID(0), readPos(0), asyncSending(false), writeInProgress(false), closeAfterSending(false), bytesPending(0), timeBlocked(0)
 {
 	init();
 }
 CConnection::CConnection(std::shared_ptr<TAcceptor> acceptor, std::shared_ptr<boost::asio::io_service> io_service, std::string Name, std::string UUID)
-	: io_service(io_service), iser(this), oser(this), name(Name), uuid(UUID), connectionID(0)
+	: io_service(io_service), iser(this), oser(this), name(Name), uuid(UUID), connectionID(0), readPos(0), asyncSending(false), writeInProgress(false), closeAfterSending(false), bytesPending(0), timeBlocked(0)
 {
 	boost::system::error_code error = asio::error::host_not_found;
 	socket = std::make_shared<tcp::socket>(*io_service);
@@ -130,12 +196,51 @@ CConnection::CConnection(std::shared_ptr<TAcceptor> acceptor, std::shared_ptr<bo
 	init();
 }
 int CConnection::write(const void * data, unsigned size)
+{
+	auto bytes = static_cast<const ui8 *>(data);
+	writeBuffer.insert(writeBuffer.end(), bytes, bytes + size);
+	return size;
+}
+int CConnection::read(void * data, unsigned size)
+{
+	auto bytes = static_cast<ui8 *>(data);
+	unsigned remaining = size;
+
+	while(remaining)
+	{
+		if(readPos == readBuffer.size())
+			receiveFrame();
+
+		unsigned chunk = std::min<size_t>(remaining, readBuffer.size() - readPos);
+		std::memcpy(bytes, readBuffer.data() + readPos, chunk);
+		readPos += chunk;
+		bytes += chunk;
+		remaining -= chunk;
+	}
+	return size;
+}
+void CConnection::flushFrame()
+{
+	CSerializedFrame frame(finishFrame());
+	writeFrame(*frame.getFrame(outgoingCompressionLevel(), compressionThreshold));
+}
+std::shared_ptr<const std::vector<ui8>> CConnection::finishFrame()
+{
+	auto frame = std::make_shared<std::vector<ui8>>(FRAME_HEADER_SIZE);
+	frame->swap(writeBuffer);
+
+	writeLittleEndian(frame->data(), frame->size() - FRAME_HEADER_SIZE);
+	return frame;
+}
+int CConnection::outgoingCompressionLevel() const
+{
+	return contactAcceptsCompression ? compressionLevel : 0;
+}
+void CConnection::writeFrame(const std::vector<ui8> & frame)
 {
 	try
 	{
-		int ret;
-		ret = asio::write(*socket,asio::const_buffers_1(asio::const_buffer(data,size)));
-		return ret;
+		asio::write(*socket, asio::buffer(frame));
 	}
 	catch(...)
 	{
@@ -144,12 +249,43 @@ int CConnection::write(const void * data, unsigned size)
 		throw;
 	}
 }
-int CConnection::read(void * data, unsigned size)
+void CConnection::receiveFrame()
 {
 	try
 	{
-		int ret = asio::read(*socket,asio::mutable_buffers_1(asio::mutable_buffer(data,size)));
-		return ret;
+		std::array<ui8, FRAME_HEADER_SIZE> header;
+		asio::read(*socket, asio::buffer(header));
+
+		ui32 length = readLittleEndian(header.data());
+		bool compressed = length & COMPRESSED_FRAME_FLAG;
+		length &= ~COMPRESSED_FRAME_FLAG;
+
+		if(length > 500000000)
+			throw std::runtime_error(boost::str(boost::format("Received frame is too big: %d bytes") % length));
+
+		readPos = 0;
+
+		if(!compressed)
+		{
+			readBuffer.resize(length);
+			asio::read(*socket, asio::buffer(readBuffer));
+			return;
+		}
+
+		std::vector<ui8> compressedData(length);
+		asio::read(*socket, asio::buffer(compressedData));
+
+		if(length < 4)
+			throw std::runtime_error("Received compressed frame is corrupted");
+
+		uLongf decompressedSize = readLittleEndian(compressedData.data());
+		if(decompressedSize > 500000000)
+			throw std::runtime_error(boost::str(boost::format("Received frame is too big: %d bytes") % decompressedSize));
+
+		readBuffer.resize(decompressedSize);
+		int ret = uncompress(readBuffer.data(), &decompressedSize, compressedData.data() + 4, length - 4);
+		if(ret != Z_OK || decompressedSize != readBuffer.size())
+			throw std::runtime_error("Failed to decompress received frame");
 	}
 	catch(...)
 	{
@@ -176,6 +312,40 @@ CConnection & CConnection::operator&(const T &t) {
 }
 
 void CConnection::close()
+{
+	boost::unique_lock<boost::mutex> lock;
+	if(mutexWrite)
+		lock = boost::unique_lock<boost::mutex>(*mutexWrite);
+
+	if(writeInProgress)
+	{
+		// don't drop queued frames, socket will be closed once they are sent
+		// client that stopped reading would keep the write pending forever, so it is cancelled after timeout
+		if(!closeAfterSending)
+		{
+			closeAfterSending = true;
+
+			auto self = shared_from_this();
+			auto timer = std::make_shared<asio::deadline_timer>(socket->get_io_service(), posix_time::seconds(CLOSE_TIMEOUT_SECONDS));
+			timer->async_wait([self, timer](const boost::system::error_code & ec)
+			{
+				boost::unique_lock<boost::mutex> lock(*self->mutexWrite);
+				if(self->writeInProgress && self->socket)
+				{
+					logNetwork->warn("%s: queued frames were not sent in time, closing", self->toString());
+					// pending write fails and its handler resets the socket
+					boost::system::error_code ignored;
+					self->socket->close(ignored);
+				}
+			});
+		}
+		return;
+	}
+
+	closeSocket();
+}
+
+void CConnection::closeSocket()
 {
 	if(socket)
 	{
@@ -196,6 +366,12 @@ void CConnection::reportState(vstd::CLoggerBase * out)
 	{
 		out->debug("\tWe have an open and valid socket");
 		out->debug("\t %d bytes awaiting", socket->available());
+		out->debug("\t %d bytes of current frame not read yet", readBuffer.size() - readPos);
+	}
+	if(asyncSending)
+	{
+		auto stats = getSendQueueStats();
+		out->debug("\t %d frames (%d bytes) waiting to be sent, blocked for %d ms in total", stats.queueDepth, stats.bytesPending, stats.timeBlocked);
 	}
 }
 
@@ -218,9 +394,113 @@ CPack * CConnection::retrievePack()
 
 void CConnection::sendPack(const CPack * pack)
 {
-	boost::unique_lock<boost::mutex> lock(*mutexWrite);
 	logNetwork->trace("Sending a pack of type %s", typeid(*pack).name());
-	oser & pack;
+	sendFrame(serializePack(pack));
+}
+
+std::shared_ptr<CSerializedFrame> CConnection::serializePack(const CPack * pack)
+{
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+	try
+	{
+		oser & pack;
+	}
+	catch(...)
+	{
+		writeBuffer.resize(FRAME_HEADER_SIZE); //don't send partially serialized pack with the next one
+		throw;
+	}
+
+	return std::make_shared<CSerializedFrame>(finishFrame());
+}
+
+void CConnection::sendFrame(std::shared_ptr<CSerializedFrame> serializedFrame)
+{
+	auto frame = serializedFrame->getFrame(outgoingCompressionLevel(), compressionThreshold);
+
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+	if(!asyncSending)
+	{
+		writeFrame(*frame);
+		return;
+	}
+
+	if(!connected)
+		return;
+
+	if(sendQueue.empty())
+		blockedSince = boost::posix_time::microsec_clock::universal_time();
+
+	sendQueue.push_back(frame);
+	bytesPending += frame->size();
+
+	if(!writeInProgress)
+		startAsyncWrite();
+}
+
+void CConnection::startAsyncWrite()
+{
+	// everything queued so far is coalesced into a single write
+	auto framesCount = sendQueue.size();
+	std::vector<asio::const_buffer> buffers;
+
+	for(auto & frame : sendQueue)
+		buffers.push_back(asio::buffer(*frame));
+
+	writeInProgress = true;
+
+	auto self = shared_from_this();
+	asio::async_write(*socket, buffers, [self, framesCount](const boost::system::error_code & ec, size_t)
+	{
+		boost::unique_lock<boost::mutex> lock(*self->mutexWrite);
+		self->writeInProgress = false;
+
+		if(ec)
+		{
+			logNetwork->error("Failed to send data to %s: %s", self->toString(), ec.message());
+			self->connected = false;
+			self->sendQueue.clear();
+			self->bytesPending = 0;
+			if(self->closeAfterSending)
+				self->closeSocket();
+			return;
+		}
+
+		for(size_t i = 0; i < framesCount; i++)
+		{
+			self->bytesPending -= self->sendQueue.front()->size();
+			self->sendQueue.pop_front();
+		}
+
+		auto now = boost::posix_time::microsec_clock::universal_time();
+		self->timeBlocked += (now - self->blockedSince).total_milliseconds();
+		self->blockedSince = now;
+
+		if(!self->sendQueue.empty())
+			self->startAsyncWrite();
+		else if(self->closeAfterSending)
+			self->closeSocket();
+	});
+}
+
+void CConnection::enableAsyncSending()
+{
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+	asyncSending = true;
+}
+
+CConnection::SendQueueStats CConnection::getSendQueueStats() const
+{
+	boost::unique_lock<boost::mutex> lock(*mutexWrite);
+
+	SendQueueStats stats;
+	stats.queueDepth = sendQueue.size();
+	stats.bytesPending = bytesPending;
+	stats.timeBlocked = timeBlocked;
+	if(!sendQueue.empty())
+		stats.timeBlocked += (boost::posix_time::microsec_clock::universal_time() - blockedSince).total_milliseconds();
+
+	return stats;
 }
 
 void CConnection::disableStackSendingByID()
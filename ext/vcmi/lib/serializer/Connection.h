@@ -44,8 +44,26 @@ namespace boost
 typedef boost::asio::basic_stream_socket < boost::asio::ip::tcp , boost::asio::stream_socket_service<boost::asio::ip::tcp>  > TSocket;
 typedef boost::asio::basic_socket_acceptor<boost::asio::ip::tcp, boost::asio::socket_acceptor_service<boost::asio::ip::tcp> > TAcceptor;
 
+/// Pack serialized once that can be sent to any number of connections
+/// Each receiver decides whether it gets compressed frame, compressed form is made once and reused
+class DLL_LINKAGE CSerializedFrame
+{
+	std::shared_ptr<const std::vector<ui8>> plain;
+	std::shared_ptr<const std::vector<ui8>> compressed; //empty if compression wasn't tried or doesn't make frame smaller
+	int compressedLevel; //level compressed form was made with, 0 if not tried yet
+
+public:
+	CSerializedFrame(std::shared_ptr<const std::vector<ui8>> plain);
+
+	/// Returns frame compressed with given level if that makes it smaller, plain frame otherwise
+	std::shared_ptr<const std::vector<ui8>> getFrame(int compressionLevel, ui32 compressionThreshold);
+};
+
 /// Main class for network communication
 /// Allows establishing connection and bidirectional read-write
+/// Data is exchanged in frames: serialized message is collected in memory and sent at once with its length,
+/// receiver reads whole frame into buffer before deserializing it
+/// Big frames can be compressed if enabled in settings and supported by other side
 class DLL_LINKAGE CConnection
 	: public IBinaryReader, public IBinaryWriter, public std::enable_shared_from_this<CConnection>
 {
@@ -55,8 +73,43 @@ class DLL_LINKAGE CConnection
 	int write(const void * data, unsigned size) override;
 	int read(void * data, unsigned size) override;
 
+	/// Sends all data written since last flush as a single frame
+	void flushFrame();
+	/// Turns data written since last flush into uncompressed frame
+	std::shared_ptr<const std::vector<ui8>> finishFrame();
+	/// Zlib level for frames sent to this connection, 0 if either side disabled compression
+	int outgoingCompressionLevel() const;
+	void writeFrame(const std::vector<ui8> & frame);
+	/// Reads next frame from socket into read buffer
+	void receiveFrame();
+	/// Writes all queued frames at once, expects mutexWrite to be held
+	void startAsyncWrite();
+	void closeSocket();
+
 	std::shared_ptr<boost::asio::io_service> io_service; //can be empty if connection made from socket
+
+	std::vector<ui8> writeBuffer; //frame being serialized starting with space for header, guarded by mutexWrite
+	std::vector<ui8> readBuffer; //last received frame, guarded by mutexRead
+	size_t readPos; //index of the next byte to be read from readBuffer
+
+	int compressionLevel; //zlib level used for outgoing frames, 0 if compression is disabled
+	ui32 compressionThreshold; //smaller frames are sent uncompressed
+
+	bool asyncSending;
+	bool writeInProgress;
+	bool closeAfterSending; //close was requested while frames were being written
+	std::deque<std::shared_ptr<const std::vector<ui8>>> sendQueue; //frames not sent yet including ones being written, guarded by mutexWrite
+	ui64 bytesPending;
+	ui64 timeBlocked;
+	boost::posix_time::ptime blockedSince; //when queue became non-empty
 public:
+	struct SendQueueStats
+	{
+		ui32 queueDepth; //frames not sent yet
+		ui64 bytesPending;
+		ui64 timeBlocked; //total time in milliseconds during which some frames were waiting to be sent
+	};
+
 	BinaryDeserializer iser;
 	BinarySerializer oser;
 
@@ -65,6 +118,7 @@ public:
 	std::shared_ptr<TSocket> socket;
 	bool connected;
 	bool myEndianess, contactEndianess; //true if little endian, if endianness is different we'll have to revert received multi-byte vars
+	bool contactAcceptsCompression;
 	std::string contactUuid;
 	std::string name; //who uses this connection
 	std::string uuid;
@@ -85,6 +139,16 @@ public:
 	CPack * retrievePack();
 	void sendPack(const CPack * pack);
 
+	/// Serializes pack into frame which can be sent to any connection in the same mode (pointer and vector member serialization settings)
+	std::shared_ptr<CSerializedFrame> serializePack(const CPack * pack);
+	/// Sends frame created by serializePack, compressed if this connection uses compression
+	void sendFrame(std::shared_ptr<CSerializedFrame> frame);
+
+	/// Frames will be queued and written by io_service of the socket instead of blocking the caller
+	/// Someone must run that io_service for as long as connection is open
+	void enableAsyncSending();
+	SendQueueStats getSendQueueStats() const;
+
 	void disableStackSendingByID();
 	void enableStackSendingByID();
 	void disableSmartPointerSerialization();
@@ -103,11 +167,4 @@ public:
 		iser & t;
 		return * this;
 	}
-
-	template<class T>
-	CConnection & operator<<(const T &t)
-	{
-		oser & t;
-		return * this;
-	}
 };
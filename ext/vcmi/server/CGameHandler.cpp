@@ -1831,12 +1831,7 @@ void CGameHandler::newTurn()
 				fw.mode = 1;
 				fw.player = player;
 				// find all hidden tiles
-				const auto & fow = getPlayerTeam(player)->fogOfWarMap;
-				for (size_t i=0; i<fow.size(); i++)
-					for (size_t j=0; j<fow.at(i).size(); j++)
-						for (size_t k=0; k<fow.at(i).at(j).size(); k++)
-							if (!fow.at(i).at(j).at(k))
-								fw.tiles.insert(int3(i,j,k));
+				getPlayerTeam(player)->fogOfWarMap.getAllTiles(fw.tiles, 1);
 
 				sendAndApply (&fw);
 			}
@@ -2549,8 +2544,7 @@ void CGameHandler::sendMessageTo(std::shared_ptr<CConnection> c, const std::stri
 {
 	SystemMessage sm;
 	sm.text = message;
-	boost::unique_lock<boost::mutex> lock(*c->mutexWrite);
-	*(c.get()) << &sm;
+	c->sendPack(&sm);
 }
 
 void CGameHandler::giveHeroBonus(GiveBonus * bonus)
@@ -2702,12 +2696,18 @@ void CGameHandler::heroExchange(ObjectInstanceID hero1, ObjectInstanceID hero2)
 void CGameHandler::sendToAllClients(CPackForClient * pack)
 {
 	logNetwork->trace("\tSending to all clients: %s", typeid(*pack).name());
+
+	// all connections are in gameplay mode, so pack is serialized the same way for each of them
+	std::shared_ptr<CSerializedFrame> frame;
 	for (auto c : lobby->connections)
 	{
 		if(!c->isOpen())
 			continue;
 
-		c->sendPack(pack);
+		if(!frame)
+			frame = c->serializePack(pack);
+
+		c->sendFrame(frame);
 	}
 }
 
@@ -6449,16 +6449,8 @@ void CGameHandler::handleCheatCode(std::string & cheat, PlayerColor player, cons
 		FoWChange fc;
 		fc.mode = (cheat == "vcmieagles" ? 1 : 0);
 		fc.player = player;
-		const auto & fowMap = gs->getPlayerTeam(player)->fogOfWarMap;
-		auto hlp_tab = new int3[gs->map->width * gs->map->height * (gs->map->twoLevel ? 2 : 1)];
-		int lastUnc = 0;
-		for (int i = 0; i < gs->map->width; i++)
-			for (int j = 0; j < gs->map->height; j++)
-				for (int k = 0; k < (gs->map->twoLevel ? 2 : 1); k++)
-					if (!fowMap.at(i).at(j).at(k) || !fc.mode)
-						hlp_tab[lastUnc++] = int3(i, j, k);
-		fc.tiles.insert(hlp_tab, hlp_tab + lastUnc);
-		delete [] hlp_tab;
+		//reveal hidden tiles or hide all of them
+		gs->getPlayerTeam(player)->fogOfWarMap.getAllTiles(fc.tiles, fc.mode ? 1 : 0);
 		sendAndApply(&fc);
 	}
 	else
@@ -6523,30 +6515,35 @@ void CGameHandler::removeAfterVisit(const CGObjectInstance *object)
 
 void CGameHandler::changeFogOfWar(int3 center, ui32 radius, PlayerColor player, bool hide)
 {
-	std::unordered_set<int3, ShashInt3> tiles;
-	getTilesInRange(tiles, center, radius, player, hide? -1 : 1);
+	FoWChange fow;
+	fow.player = player;
+	fow.mode = hide? 0 : 1;
 	if (hide)
 	{
-		std::unordered_set<int3, ShashInt3> observedTiles; //do not hide tiles observed by heroes. May lead to disastrous AI problems
+		//do not hide tiles observed by heroes. May lead to disastrous AI problems
+		//observed tiles are marked as hidden in a copy of the map, so only the rest remains visible there
+		CFogOfWarMap hideable = getPlayerTeam(player)->fogOfWarMap;
 		auto p = getPlayer(player);
 		for (auto h : p->heroes)
 		{
-			getTilesInRange(observedTiles, h->getSightCenter(), h->getSightRadius(), h->tempOwner, -1);
+			hideable.hideRange(h->getSightCenter(), h->getSightRadius());
 		}
 		for (auto t : p->towns)
 		{
-			getTilesInRange(observedTiles, t->getSightCenter(), t->getSightRadius(), t->tempOwner, -1);
+			hideable.hideRange(t->getSightCenter(), t->getSightRadius());
 		}
-		for (auto tile : observedTiles)
-			vstd::erase_if_present (tiles, tile);
+		hideable.getTilesInRange(fow.tiles, center, radius, -1);
 	}
-	changeFogOfWar(tiles, player, hide);
+	else
+		getTilesInRange(fow.tiles, center, radius, player, 1);
+	sendAndApply(&fow);
 }
 
 void CGameHandler::changeFogOfWar(std::unordered_set<int3, ShashInt3> &tiles, PlayerColor player, bool hide)
 {
 	FoWChange fow;
-	fow.tiles = tiles;
+	for (auto tile : tiles)
+		fow.tiles.add(tile);
 	fow.player = player;
 	fow.mode = hide? 0 : 1;
 	sendAndApply(&fow);
@@ -150,6 +150,25 @@ CVCMIServer::~CVCMIServer()
 
 	if(announceLobbyThread)
 		announceLobbyThread->join();
+
+	if(networkThread)
+	{
+		io->stop();
+		networkThread->join();
+	}
+
+	{
+		// unblock handshakes still waiting for their clients, they must not outlive the server
+		boost::unique_lock<boost::recursive_mutex> myLock(mx);
+		state = EServerState::SHUTDOWN;
+		for(auto socket : handshakeSockets)
+		{
+			boost::system::error_code ec;
+			socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+			socket->close(ec);
+		}
+	}
+	handshakeThreads.join_all();
 }
 
 void CVCMIServer::run()
@@ -157,6 +176,7 @@ void CVCMIServer::run()
 	if(!restartGameplay)
 	{
 		this->announceLobbyThread = vstd::make_unique<boost::thread>(&CVCMIServer::threadAnnounceLobby, this);
+		networkThread = vstd::make_unique<boost::thread>(&CVCMIServer::threadNetwork, this);
 #ifndef VCMI_ANDROID
 		if(cmdLineOptions.count("enable-shm"))
 		{
@@ -209,18 +229,20 @@ void CVCMIServer::threadAnnounceLobby()
 				if(acceptor)
 					acceptor->close();
 			}
-
-			if(acceptor)
-			{
-				acceptor->get_io_service().reset();
-				acceptor->get_io_service().poll();
-			}
 		}
 
 		boost::this_thread::sleep(boost::posix_time::milliseconds(50));
 	}
 }
 
+void CVCMIServer::threadNetwork()
+{
+	setThreadName("CVCMIServer::threadNetwork");
+	// accepts new connections and sends queued packs to clients until server is destroyed
+	boost::asio::io_service::work work(*io);
+	io->run();
+}
+
 void CVCMIServer::prepareToStartGame()
 {
 	if(state == EServerState::GAMEPLAY)
@@ -276,6 +298,7 @@ void CVCMIServer::startAsyncAccept()
 
 void CVCMIServer::connectionAccepted(const boost::system::error_code & ec)
 {
+	boost::unique_lock<boost::recursive_mutex> myLock(mx);
 	if(ec)
 	{
 		if(state != EServerState::SHUTDOWN)
@@ -283,21 +306,38 @@ void CVCMIServer::connectionAccepted(const boost::system::error_code & ec)
 		return;
 	}
 
+	logNetwork->info("We got a new connection! :)");
+	// handshake waits for the client while this thread also writes queued frames of all clients
+	handshakeSockets.insert(upcomingConnection);
+	handshakeThreads.create_thread(std::bind(&CVCMIServer::threadHandshakeClient, this, upcomingConnection));
+	upcomingConnection.reset();
+
+	startAsyncAccept();
+}
+
+void CVCMIServer::threadHandshakeClient(std::shared_ptr<TSocket> socket)
+{
+	setThreadName("CVCMIServer::handshakeClient");
+
 	try
 	{
-		logNetwork->info("We got a new connection! :)");
-		auto c = std::make_shared<CConnection>(upcomingConnection, NAME, uuid);
-		upcomingConnection.reset();
+		auto c = std::make_shared<CConnection>(socket, NAME, uuid);
+		c->enableAsyncSending();
+
+		boost::unique_lock<boost::recursive_mutex> myLock(mx);
+		handshakeSockets.erase(socket);
+		if(state == EServerState::SHUTDOWN)
+			return;
+
 		connections.insert(c);
 		c->handler = std::make_shared<boost::thread>(&CVCMIServer::threadHandleClient, this, c);
 	}
 	catch(std::exception & e)
 	{
-		upcomingConnection.reset();
+		boost::unique_lock<boost::recursive_mutex> myLock(mx);
+		handshakeSockets.erase(socket);
 		logNetwork->info("I guess it was just my imagination!");
 	}
-
-	startAsyncAccept();
 }
 
 void CVCMIServer::threadHandleClient(std::shared_ptr<CConnection> c)
@@ -48,6 +48,9 @@ class CVCMIServer : public LobbyInfo
 	boost::recursive_mutex mx;
 	std::shared_ptr<CApplier<CBaseForServerApply>> applier;
 	std::unique_ptr<boost::thread> announceLobbyThread;
+	std::unique_ptr<boost::thread> networkThread;
+	boost::thread_group handshakeThreads;
+	std::set<std::shared_ptr<TSocket>> handshakeSockets; //sockets of clients still in handshake, guarded by mx
 
 public:
 	std::shared_ptr<CGameHandler> gh;
@@ -68,8 +71,10 @@ public:
 
 	void startAsyncAccept();
 	void connectionAccepted(const boost::system::error_code & ec);
+	void threadHandshakeClient(std::shared_ptr<TSocket> socket);
 	void threadHandleClient(std::shared_ptr<CConnection> c);
 	void threadAnnounceLobby();
+	void threadNetwork();
 	void handleReceivedPack(std::unique_ptr<CPackForLobby> pack);
 
 	void announcePack(std::unique_ptr<CPackForLobby> pack);
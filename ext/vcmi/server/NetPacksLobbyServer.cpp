@@ -84,7 +84,6 @@ void LobbyClientDisconnected::applyOnServerAfterAnnounce(CVCMIServer * srv)
 {
 	if(c->isOpen())
 	{
-		boost::unique_lock<boost::mutex> lock(*c->mutexWrite);
 		c->close();
 		c->connected = false;
 	}
@@ -0,0 +1,49 @@
+/*
+ * BinarySerializerTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+
+#include "StdInc.h"
+#include "../lib/serializer/CMemorySerializer.h"
+
+TEST(BinarySerializerTest, multiArrayRoundTrip)
+{
+	boost::multi_array<si16, 3> original(boost::extents[3][4][2]);
+	for(size_t i = 0; i < original.num_elements(); i++)
+		original.data()[i] = i * 7 - 20;
+
+	CMemorySerializer mem;
+	mem.oser & original;
+
+	boost::multi_array<si16, 3> copy;
+	mem.iser & copy;
+
+	ASSERT_TRUE(std::equal(original.shape(), original.shape() + 3, copy.shape()));
+	EXPECT_TRUE(original == copy);
+}
+
+TEST(BinarySerializerTest, corruptMultiArrayShapeIsRejected)
+{
+	CMemorySerializer mem;
+	mem.oser & ui32(100000) & ui32(100000) & ui32(100000);
+
+	boost::multi_array<ui8, 3> data;
+	EXPECT_THROW(mem.iser & data, std::runtime_error);
+	EXPECT_EQ(data.num_elements(), 0);
+}
+
+TEST(BinarySerializerTest, multiArrayTooBigInBytesIsRejected)
+{
+	//element count fits in ui32 but array could not have been saved as single block
+	CMemorySerializer mem;
+	mem.oser & ui32(65536) & ui32(32768) & ui32(1);
+
+	boost::multi_array<si32, 3> data;
+	EXPECT_THROW(mem.iser & data, std::runtime_error);
+	EXPECT_EQ(data.num_elements(), 0);
+}
@@ -0,0 +1,96 @@
+/*
+ * CFogOfWarMapTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../lib/CFogOfWarMap.h"
+
+namespace
+{
+	const int3 mapSize(150, 70, 2);
+
+	std::set<int3> toSet(const CTileRuns & runs)
+	{
+		auto tiles = runs.getTiles();
+		return std::set<int3>(tiles.begin(), tiles.end());
+	}
+
+	//tiles selected the same way as CPrivilegedInfoCallback::getTilesInRange did tile by tile
+	std::set<int3> expectedInRange(const std::vector<ui8> & visible, int3 center, int radius, int mode, int3::EDistanceFormula formula)
+	{
+		std::set<int3> ret;
+		for(int x = std::max(center.x - radius, 0); x <= std::min(center.x + radius, mapSize.x - 1); x++)
+		{
+			for(int y = std::max(center.y - radius, 0); y <= std::min(center.y + radius, mapSize.y - 1); y++)
+			{
+				int3 tile(x, y, center.z);
+				bool isVisible = visible[(center.z * mapSize.y + y) * mapSize.x + x];
+				if(center.dist(tile, formula) <= radius && (mode == 0 || (mode == 1) != isVisible))
+					ret.insert(tile);
+			}
+		}
+		return ret;
+	}
+}
+
+TEST(CFogOfWarMapTest, matchesTileByTileVisibility)
+{
+	CFogOfWarMap fow;
+	fow.resize(mapSize);
+	std::vector<ui8> expected(mapSize.x * mapSize.y * mapSize.z, 0);
+
+	const int3::EDistanceFormula formulas[] = {int3::DIST_2D, int3::DIST_MANHATTAN, int3::DIST_CHEBYSHEV, int3::DIST_2DSQ};
+
+	for(int i = 0; i < 400; i++)
+	{
+		int3 center((i * 37) % (mapSize.x + 20) - 10, (i * 13) % (mapSize.y + 20) - 10, i % mapSize.z);
+		int radius = (i * 7) % 30;
+		auto formula = formulas[i % 4];
+		int mode = i % 3 - 1;
+
+		CTileRuns found;
+		fow.getTilesInRange(found, center, radius, mode, formula);
+		EXPECT_EQ(toSet(found), expectedInRange(expected, center, radius, mode, formula));
+
+		bool reveal = i % 5 != 0;
+		for(const int3 & tile : expectedInRange(expected, center, radius, 0, formula))
+			expected[(tile.z * mapSize.y + tile.y) * mapSize.x + tile.x] = reveal;
+		if(reveal)
+			fow.revealRange(center, radius, formula);
+		else
+			fow.hideRange(center, radius, formula);
+	}
+
+	for(int z = 0; z < mapSize.z; z++)
+		for(int y = 0; y < mapSize.y; y++)
+			for(int x = 0; x < mapSize.x; x++)
+				EXPECT_EQ(fow.isVisible(int3(x, y, z)), expected[(z * mapSize.y + y) * mapSize.x + x] != 0);
+
+	CTileRuns hidden;
+	fow.getAllTiles(hidden, 1);
+	CFogOfWarMap copy = fow;
+	copy.setVisible(hidden, true);
+	CTileRuns stillHidden;
+	copy.getAllTiles(stillHidden, 1);
+	EXPECT_TRUE(stillHidden.empty());
+}
+
+TEST(CTileRunsTest, joinsAdjacentTiles)
+{
+	CTileRuns runs;
+	runs.add(int3(3, 1, 0));
+	runs.add(int3(4, 1, 0), 5);
+	runs.add(int3(9, 1, 0));
+	runs.add(int3(10, 2, 0));
+
+	ASSERT_EQ(runs.getRuns().size(), 2);
+	EXPECT_EQ(runs.getRuns()[0].start, int3(3, 1, 0));
+	EXPECT_EQ(runs.getRuns()[0].length, 7);
+	EXPECT_EQ(runs.getTiles().size(), 8);
+}
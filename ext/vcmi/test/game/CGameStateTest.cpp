@@ -14,6 +14,7 @@
 
 #include "../../lib/VCMIDirs.h"
 #include "../../lib/CGameState.h"
+#include "../../lib/CPathfinder.h"
 #include "../../lib/NetPacks.h"
 #include "../../lib/StartInfo.h"
 
@@ -23,6 +24,7 @@
 #include "../../lib/filesystem/ResourceID.h"
 
 #include "../../lib/mapping/CMap.h"
+#include "../../lib/mapObjects/CGHeroInstance.h"
 
 #include "../../lib/spells/CSpellHandler.h"
 #include "../../lib/spells/ISpellMechanics.h"
@@ -331,3 +333,264 @@ TEST_F(CGameStateTest, battleResurrection)
 	EXPECT_EQ(unit->health.getCount(), 10);
 	EXPECT_EQ(unit->health.getResurrected(), 0);
 }
+
+static const CGPathNode * findFirstStep(const CPathsInfo & paths, const CMap * map, const int3 & start)
+{
+	for(int dx = -1; dx <= 1; dx++)
+	{
+		for(int dy = -1; dy <= 1; dy++)
+		{
+			int3 tile = start + int3(dx, dy, 0);
+			if(!map->isInTheMap(tile) || tile == start)
+				continue;
+
+			const CGPathNode * node = paths.getPathInfo(tile);
+			if(node->turns == 0 && node->action == CGPathNode::NORMAL && node->theNodeBefore && node->theNodeBefore->coord == start)
+				return node;
+		}
+	}
+
+	return nullptr;
+}
+
+static void expectSamePaths(CPathsInfo & expectedPaths, CPathsInfo & actualPaths)
+{
+	const int3 & mapSize = expectedPaths.sizes;
+
+	int3 pos;
+	for(pos.x = 0; pos.x < mapSize.x; pos.x++)
+	{
+		for(pos.y = 0; pos.y < mapSize.y; pos.y++)
+		{
+			for(pos.z = 0; pos.z < mapSize.z; pos.z++)
+			{
+				for(EPathfindingLayer layer = EPathfindingLayer::LAND; layer <= EPathfindingLayer::AIR; layer.advance(1))
+				{
+					const CGPathNode * expected = expectedPaths.getNode(pos, layer);
+					const CGPathNode * actual = actualPaths.getNode(pos, layer);
+
+					EXPECT_EQ(actual->reachable(), expected->reachable()) << pos.toString();
+					EXPECT_EQ(actual->turns, expected->turns) << pos.toString();
+					EXPECT_EQ(actual->moveRemains, expected->moveRemains) << pos.toString();
+					EXPECT_EQ(actual->action, expected->action) << pos.toString();
+				}
+			}
+		}
+	}
+}
+
+static std::shared_ptr<PathfinderConfig> makePathfinderConfig(CPathsInfo & out, const CGHeroInstance * hero)
+{
+	return std::make_shared<PathfinderConfig>(
+		std::make_shared<NodeStorage>(out, hero),
+		std::vector<std::shared_ptr<IPathfindingRule>>{
+			std::make_shared<LayerTransitionRule>(),
+			std::make_shared<DestinationActionRule>(),
+			std::make_shared<MovementToDestinationRule>(),
+			std::make_shared<MovementCostRule>(),
+			std::make_shared<MovementAfterDestinationRule>()
+		});
+}
+
+TEST_F(CGameStateTest, pathfinderRepairMatchesFullSearch)
+{
+	startTestGame();
+
+	CGHeroInstance * hero = map->heroesOnMap[0];
+	const int3 mapSize = gameState->getMapSize();
+
+	CPathsInfo repaired(mapSize);
+	auto repairConfig = [&]()
+	{
+		auto config = makePathfinderConfig(repaired, hero);
+		config->options.incrementalRepair = true;
+		return config;
+	};
+
+	gameState->calculatePaths(repairConfig(), hero);
+
+	EXPECT_EQ(repaired.repairedSearches, 0u);
+	EXPECT_EQ(repaired.fullSearches, 1u);
+
+	const CGPathNode * step = findFirstStep(repaired, map, hero->getPosition(false));
+
+	ASSERT_NE(step, nullptr);
+
+	{
+		TryMoveHero pack;
+		pack.id = hero->id;
+		pack.start = hero->pos;
+		pack.end = CGHeroInstance::convertPosition(step->coord, true);
+		pack.movePoints = step->moveRemains;
+		pack.result = TryMoveHero::SUCCESS;
+		gameCallback->sendAndApply(&pack);
+	}
+
+	ASSERT_EQ(hero->getPosition(false), step->coord);
+
+	//same as client does when paths are invalidated
+	repaired.hero = nullptr;
+	gameState->calculatePaths(repairConfig(), hero);
+
+	EXPECT_EQ(repaired.repairedSearches, 1u);
+	EXPECT_EQ(repaired.fullSearches, 1u);
+
+	CPathsInfo full(mapSize);
+	auto fullConfig = makePathfinderConfig(full, hero);
+	fullConfig->options.incrementalRepair = false;
+	gameState->calculatePaths(fullConfig, hero);
+
+	expectSamePaths(full, repaired);
+}
+
+TEST_F(CGameStateTest, pathfinderRepairFallsBackWhenObjectBlocksTile)
+{
+	startTestGame();
+
+	CGHeroInstance * hero = map->heroesOnMap[0];
+	const int3 mapSize = gameState->getMapSize();
+
+	CPathsInfo repaired(mapSize);
+	auto repairConfig = [&]()
+	{
+		auto config = makePathfinderConfig(repaired, hero);
+		config->options.incrementalRepair = true;
+		return config;
+	};
+
+	gameState->calculatePaths(repairConfig(), hero);
+
+	const int3 start = hero->getPosition(false);
+	const CGPathNode * step = findFirstStep(repaired, map, start);
+
+	ASSERT_NE(step, nullptr);
+
+	//free tile reached by previous search away from tiles hero moves between
+	int3 blockedTile(-1, -1, -1);
+	for(int x = 0; x < mapSize.x && !map->isInTheMap(blockedTile); x++)
+	{
+		for(int y = 0; y < mapSize.y && !map->isInTheMap(blockedTile); y++)
+		{
+			int3 tile(x, y, start.z);
+			const TerrainTile & t = map->getTile(tile);
+
+			if(start.dist2dSQ(tile) > 8 && step->coord.dist2dSQ(tile) > 8 && !t.blocked && !t.visitable && repaired.getPathInfo(tile)->reachable())
+				blockedTile = tile;
+		}
+	}
+
+	ASSERT_TRUE(map->isInTheMap(blockedTile));
+
+	{
+		NewObject pack;
+		pack.ID = Obj::MONSTER;
+		pack.subID = 0;
+		pack.pos = blockedTile;
+		gameCallback->sendAndApply(&pack);
+	}
+
+	{
+		TryMoveHero pack;
+		pack.id = hero->id;
+		pack.start = hero->pos;
+		pack.end = CGHeroInstance::convertPosition(step->coord, true);
+		pack.movePoints = step->moveRemains;
+		pack.result = TryMoveHero::SUCCESS;
+		gameCallback->sendAndApply(&pack);
+	}
+
+	ASSERT_EQ(hero->getPosition(false), step->coord);
+
+	repaired.hero = nullptr;
+	gameState->calculatePaths(repairConfig(), hero);
+
+	//part of previous tree leads through tile that is now guarded so it can't be reused
+	EXPECT_EQ(repaired.repairedSearches, 0u);
+	EXPECT_EQ(repaired.fullSearches, 2u);
+
+	CPathsInfo full(mapSize);
+	auto fullConfig = makePathfinderConfig(full, hero);
+	fullConfig->options.incrementalRepair = false;
+	gameState->calculatePaths(fullConfig, hero);
+
+	expectSamePaths(full, repaired);
+}
+
+TEST_F(CGameStateTest, pathfinderBucketQueueMatchesHeap)
+{
+	startTestGame();
+
+	for(CGHeroInstance * hero : map->heroesOnMap)
+	{
+		const int3 mapSize = gameState->getMapSize();
+
+		CPathsInfo heap(mapSize);
+		auto heapConfig = makePathfinderConfig(heap, hero);
+		heapConfig->options.useBucketQueue = false;
+		gameState->calculatePaths(heapConfig, hero);
+
+		CPathsInfo bucket(mapSize);
+		auto bucketConfig = makePathfinderConfig(bucket, hero);
+		bucketConfig->options.useBucketQueue = true;
+		gameState->calculatePaths(bucketConfig, hero);
+
+		expectSamePaths(heap, bucket);
+	}
+}
+
+TEST_F(CGameStateTest, pathfinderBucketQueueMatchesHeapWithFreeBoarding)
+{
+	startTestGame();
+
+	CGHeroInstance * hero = map->heroesOnMap[0];
+	const int3 mapSize = gameState->getMapSize();
+	const int3 start = hero->getPosition(false);
+
+	ASSERT_LT(start.y + 1, mapSize.y);
+
+	int3 pos;
+	for(pos.x = 0; pos.x < mapSize.x; pos.x++)
+	{
+		for(pos.y = start.y + 1; pos.y < mapSize.y; pos.y++)
+		{
+			for(pos.z = 0; pos.z < mapSize.z; pos.z++)
+				map->getTile(pos).terType = ETerrainType::WATER;
+		}
+	}
+
+	const int3 boatTile = start + int3(0, 1, 0);
+	{
+		NewObject pack;
+		pack.ID = Obj::BOAT;
+		pack.pos = CGHeroInstance::convertPosition(boatTile, true);
+		gameCallback->sendAndApply(&pack);
+
+		ASSERT_EQ(map->objects[pack.id.getNum()]->visitablePos(), boatTile);
+	}
+
+	//hero embarking has more movement points than hero standing on shore
+	hero->addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::FREE_SHIP_BOARDING, Bonus::OTHER, 0, 0));
+	hero->addNewBonus(std::make_shared<Bonus>(Bonus::PERMANENT, Bonus::SEA_MOVEMENT, Bonus::OTHER, 1000, 0));
+
+	auto calculatePaths = [&](CPathsInfo & out, bool useBucketQueue)
+	{
+		auto config = makePathfinderConfig(out, hero);
+
+		config->options.useEmbarkAndDisembark = true;
+		config->options.useBucketQueue = useBucketQueue;
+
+		gameState->calculatePaths(config, hero);
+	};
+
+	CPathsInfo heap(mapSize);
+	calculatePaths(heap, false);
+
+	CPathsInfo bucket(mapSize);
+	calculatePaths(bucket, true);
+
+	const CGPathNode * embark = heap.getNode(boatTile, EPathfindingLayer::SAIL);
+	ASSERT_EQ(embark->action, CGPathNode::EMBARK);
+	ASSERT_GT(embark->moveRemains, hero->movement);
+
+	expectSamePaths(heap, bucket);
+}
@@ -0,0 +1,173 @@
+/*
+ * CMapGeneratorTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/VCMI_Lib.h"
+#include "../../lib/CArtHandler.h"
+#include "../../lib/CCreatureHandler.h"
+#include "../../lib/CHeroHandler.h"
+#include "../../lib/CTownHandler.h"
+#include "../../lib/spells/CSpellHandler.h"
+#include "../../lib/mapping/CMap.h"
+#include "../../lib/mapObjects/MiscObjects.h"
+#include "../../lib/rmg/CMapGenOptions.h"
+#include "../../lib/rmg/CMapGenerator.h"
+#include "../../lib/rmg/CRmgTemplate.h"
+#include "../../lib/rmg/CRmgTemplateStorage.h"
+#include "../../lib/serializer/BinarySerializer.h"
+#include "../../lib/registerTypes/RegisterTypes.h"
+
+#ifndef VCMI_WINDOWS
+	#include <sys/resource.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+namespace test
+{
+
+class CMapBytesWriter : public IBinaryWriter
+{
+public:
+	std::vector<ui8> bytes;
+
+	int write(const void * data, unsigned size) override
+	{
+		auto begin = static_cast<const ui8 *>(data);
+		bytes.insert(bytes.end(), begin, begin + size);
+		return size;
+	}
+};
+
+/// Game data referenced by the map is serialized as well, it is the same for both maps
+static std::vector<ui8> serializeMap(CMap & map)
+{
+	CMapBytesWriter writer;
+	BinarySerializer oser(&writer);
+	registerTypes(oser);
+
+	oser & map;
+	return writer.bytes;
+}
+
+static std::unique_ptr<CMap> generateMap(CMapGenerator & gen, const CRmgTemplate * tmpl, const int3 & size, int seed)
+{
+	CMapGenOptions opt;
+	opt.setWidth(size.x);
+	opt.setHeight(size.y);
+	opt.setHasTwoLevels(size.z == 2);
+	if(tmpl)
+		opt.setMapTemplate(tmpl);
+
+	return gen.generate(&opt, seed);
+}
+
+#ifndef VCMI_WINDOWS
+static long getPeakMemoryKb()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+#endif
+
+/// Peak memory of the process only grows, so map is generated once more in forked child which starts with its current memory usage.
+/// Returns growth of child's peak memory or -1 if it can't be measured
+static long measureGenerationMemoryKb(const CRmgTemplate * tmpl, const int3 & size, int seed)
+{
+#ifndef VCMI_WINDOWS
+	int fds[2];
+	if(pipe(fds) != 0)
+		return -1;
+
+	std::cout.flush(); //child would print buffered output once more
+	pid_t pid = fork();
+	if(pid == 0)
+	{
+		close(fds[0]);
+		long before = getPeakMemoryKb();
+		CMapGenerator gen;
+		auto map = generateMap(gen, tmpl, size, seed);
+		long used = map ? getPeakMemoryKb() - before : -1;
+		ssize_t written = write(fds[1], &used, sizeof(used));
+		_exit(written == sizeof(used) ? 0 : 1);
+	}
+
+	close(fds[1]);
+	long used = -1;
+	if(pid > 0)
+	{
+		if(read(fds[0], &used, sizeof(used)) != sizeof(used))
+			used = -1;
+		waitpid(pid, nullptr, 0);
+	}
+	close(fds[0]);
+	return used;
+#else
+	return -1;
+#endif
+}
+
+TEST(CMapGeneratorTest, sameSeedGivesIdenticalMap)
+{
+	const int3 size(CMapHeader::MAP_SIZE_SMALL, CMapHeader::MAP_SIZE_SMALL, 2);
+
+	CMapGenerator firstGen, secondGen;
+	auto first = generateMap(firstGen, nullptr, size, 1337);
+	auto second = generateMap(secondGen, nullptr, size, 1337);
+
+	ASSERT_TRUE(first && second);
+	EXPECT_TRUE(serializeMap(*first) == serializeMap(*second));
+}
+
+/// Generates maps for every template, map size and few seeds, prints time spent in each phase.
+/// Too slow for regular runs, use --gtest_also_run_disabled_tests --gtest_filter=*benchmarkTemplates
+TEST(CMapGeneratorTest, DISABLED_benchmarkTemplates)
+{
+	const std::vector<int> mapSizes = {CMapHeader::MAP_SIZE_SMALL, CMapHeader::MAP_SIZE_MIDDLE, CMapHeader::MAP_SIZE_LARGE, CMapHeader::MAP_SIZE_XLARGE};
+	const std::vector<int> seeds = {1, 2, 3};
+
+	for(const auto & templatePair : VLC->tplh->getTemplates())
+	{
+		for(int mapSize : mapSizes)
+		{
+			for(int levels = 1; levels <= 2; levels++)
+			{
+				const int3 size(mapSize, mapSize, levels);
+				if(!templatePair.second->matchesSize(size))
+					continue;
+
+				for(int seed : seeds)
+				{
+					SCOPED_TRACE(boost::str(boost::format("template %s, size %s, seed %d") % templatePair.first % size.toString() % seed));
+
+					CMapGenerator gen;
+					auto begin = boost::chrono::steady_clock::now();
+					auto map = generateMap(gen, templatePair.second, size, seed);
+					auto total = boost::chrono::duration_cast<boost::chrono::milliseconds>(boost::chrono::steady_clock::now() - begin).count();
+					ASSERT_TRUE(map != nullptr);
+					long memory = measureGenerationMemoryKb(templatePair.second, size, seed);
+
+					std::cout << templatePair.first << " " << size.toString() << " seed " << seed << ": total " << total << " ms";
+					for(const auto & phase : gen.getPhaseTimes())
+						std::cout << ", " << phase.first << " " << phase.second << " ms";
+					std::cout << ", peak memory growth " << memory << " KB" << std::endl;
+
+					CMapGenerator otherGen;
+					auto otherMap = generateMap(otherGen, templatePair.second, size, seed);
+					ASSERT_TRUE(otherMap != nullptr);
+					EXPECT_TRUE(serializeMap(*map) == serializeMap(*otherMap));
+				}
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,65 @@
+/*
+ * CTileSetTest.cpp, part of VCMI engine
+ *
+ * Authors: listed in file AUTHORS in main folder
+ *
+ * License: GNU General Public License v2.0 or later
+ * Full text of license available in license.txt file, in main folder
+ *
+ */
+#include "StdInc.h"
+
+#include "../../lib/rmg/CTileSet.h"
+
+TEST(CTileSetTest, matchesStdSet)
+{
+	const int3 mapSize(70, 45, 2);
+
+	CTileSet tiles(mapSize);
+	std::set<int3> expected;
+
+	for(int i = 0; i < 3000; i++)
+	{
+		int3 tile((i * 37) % mapSize.x, (i * 11) % mapSize.y, (i / 7) % mapSize.z);
+
+		if(i % 3 == 0)
+			EXPECT_EQ(tiles.erase(tile), expected.erase(tile) > 0);
+		else
+			EXPECT_EQ(tiles.insert(tile), expected.insert(tile).second);
+	}
+
+	EXPECT_EQ(tiles.size(), expected.size());
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), tiles.begin()));
+	EXPECT_TRUE(std::equal(expected.rbegin(), expected.rend(), boost::adaptors::reverse(tiles).begin()));
+
+	EXPECT_FALSE(tiles.contains(int3(-1, 0, 0)));
+	EXPECT_FALSE(tiles.contains(int3(0, 0, 2)));
+
+	tiles.eraseIf([](const int3 & tile)
+	{
+		return tile.x < 35;
+	});
+	EXPECT_EQ(tiles.size(), std::count_if(expected.begin(), expected.end(), [](const int3 & tile)
+	{
+		return tile.x >= 35;
+	}));
+
+	tiles.clear();
+	EXPECT_TRUE(tiles.empty());
+	EXPECT_TRUE(tiles.begin() == tiles.end());
+}
+
+TEST(CTileSetTest, tileMapClear)
+{
+	CTileMap<int> values;
+	values.resize(int3(8, 8, 1));
+
+	values[int3(1, 2, 0)] = 5;
+	EXPECT_TRUE(values.contains(int3(1, 2, 0)));
+	EXPECT_EQ(*values.find(int3(1, 2, 0)), 5);
+	EXPECT_EQ(values.find(int3(2, 1, 0)), nullptr);
+
+	values.clear();
+	EXPECT_FALSE(values.contains(int3(1, 2, 0)));
+	EXPECT_EQ(values[int3(1, 2, 0)], 0);
+}
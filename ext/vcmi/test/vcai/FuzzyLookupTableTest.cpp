@@ -0,0 +1,145 @@
+/*
+* FuzzyLookupTableTest.cpp, part of VCMI engine
+*
+* Authors: listed in file AUTHORS in main folder
+*
+* License: GNU General Public License v2.0 or later
+* Full text of license available in license.txt file, in main folder
+*
+*/
+#include "StdInc.h"
+
+#include "../AI/VCAI/FuzzyLookupTable.h"
+#include "../AI/VCAI/FuzzyGoalRules.h"
+
+namespace
+{
+	const double SAFE_ATTACK = 1.5; //SAFE_ATTACK_CONSTANT of AI
+
+	//goals are picked by comparing their values, table may reorder only goals with close values
+	//limits are fractions of 0-5 value range: 0.5% on average, 2.5% for 99% of inputs, 7.5% at worst
+	const fl::scalar MAX_MEAN_ERROR = 0.025;
+	const fl::scalar MAX_P99_ERROR = 0.125;
+	const fl::scalar MAX_ERROR = 0.375;
+
+	/// engine with variables and rules of VisitTileEngine or VisitObjEngine, without AI state needed to evaluate goals
+	struct GoalEngine
+	{
+		fl::Engine engine; //owns all variables and rules
+		HeroMovementGoalVariables vars;
+		fl::InputVariable * objectValue;
+
+		GoalEngine(bool visitObj)
+			: objectValue(nullptr)
+		{
+			auto rules = new fl::RuleBlock();
+			engine.addRuleBlock(rules);
+
+			vars = addHeroMovementGoalRules(engine, *rules, SAFE_ATTACK);
+			if(visitObj)
+				objectValue = addObjectValueRules(engine, *rules);
+
+			configureFuzzyEngine(engine);
+		}
+
+		/// sets random input values, up to given fraction outside of input ranges
+		void randomize(std::mt19937 & rand, fl::scalar outside)
+		{
+			for(auto input : engine.inputVariables())
+			{
+				fl::scalar span = input->getMaximum() - input->getMinimum();
+				std::uniform_real_distribution<fl::scalar> distribution(input->getMinimum(), input->getMaximum() + span * outside);
+				input->setValue(distribution(rand));
+			}
+		}
+
+		fl::scalar process()
+		{
+			engine.process();
+			return vars.value->getValue();
+		}
+	};
+
+	struct Accuracy
+	{
+		fl::scalar mean, p99, max;
+	};
+
+	/// difference between table and engine over random inputs
+	Accuracy compare(GoalEngine & goalEngine, const FuzzyLookupTable & table)
+	{
+		std::mt19937 rand(42);
+		std::vector<fl::scalar> errors;
+
+		for(int i = 0; i < 5000; i++)
+		{
+			//memberships of border terms saturate outside of range, same as clamped table inputs
+			goalEngine.randomize(rand, 0.2);
+			fl::scalar actual = table.evaluate();
+			fl::scalar expected = goalEngine.process();
+			errors.push_back(std::abs(expected - actual));
+		}
+		std::sort(errors.begin(), errors.end());
+
+		Accuracy result;
+		result.mean = std::accumulate(errors.begin(), errors.end(), fl::scalar(0)) / errors.size();
+		result.p99 = errors[errors.size() * 99 / 100];
+		result.max = errors.back();
+		return result;
+	}
+
+	void checkAccuracy(bool visitObj, const std::vector<int> & subdivisions)
+	{
+		GoalEngine goalEngine(visitObj);
+		FuzzyLookupTable table;
+		table.build(goalEngine.engine, goalEngine.engine.inputVariables(), goalEngine.vars.value, subdivisions);
+		ASSERT_TRUE(table.isBuilt());
+
+		Accuracy accuracy = compare(goalEngine, table);
+		EXPECT_LT(accuracy.mean, MAX_MEAN_ERROR);
+		EXPECT_LT(accuracy.p99, MAX_P99_ERROR);
+		EXPECT_LT(accuracy.max, MAX_ERROR);
+	}
+}
+
+TEST(FuzzyLookupTableTest, matchesVisitTileEngine)
+{
+	checkAccuracy(false, VISIT_TILE_TABLE_SUBDIVISIONS);
+}
+
+TEST(FuzzyLookupTableTest, matchesVisitObjEngine)
+{
+	checkAccuracy(true, VISIT_OBJ_TABLE_SUBDIVISIONS);
+}
+
+TEST(FuzzyLookupTableTest, exactAtBreakPoints)
+{
+	GoalEngine goalEngine(false);
+	goalEngine.vars.strengthRatio->setValue(2);
+	goalEngine.vars.turnDistance->setValue(0.3);
+
+	//inputs that are not sampled keep their values
+	FuzzyLookupTable table;
+	table.build(goalEngine.engine, {goalEngine.vars.heroStrength, goalEngine.vars.missionImportance}, goalEngine.vars.value, {1, 1});
+	EXPECT_EQ(table.size(), 5 * 5);
+
+	for(fl::scalar hero : {0.0, 0.2, 0.5, 0.8, 1.0})
+	{
+		for(fl::scalar importance : {0.0, 2.0, 2.5, 3.0, 5.0})
+		{
+			goalEngine.vars.heroStrength->setValue(hero);
+			goalEngine.vars.missionImportance->setValue(importance);
+			EXPECT_NEAR(table.evaluate(), goalEngine.process(), 1e-6);
+		}
+	}
+}
+
+TEST(FuzzyLookupTableTest, buildKeepsInputValues)
+{
+	GoalEngine goalEngine(false);
+	goalEngine.vars.heroStrength->setValue(0.3);
+
+	FuzzyLookupTable table;
+	table.build(goalEngine.engine, goalEngine.engine.inputVariables(), goalEngine.vars.value, {1, 1, 1, 1});
+	EXPECT_EQ(goalEngine.vars.heroStrength->getValue(), 0.3);
+}